@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2013-2014 Intel Corporation.
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Authors:
+ *   José Bollo <jose.bollo@open.eurogiciel.org>
+ *   Stéphane Desneux <stephane.desneux@open.eurogiciel.org>
+ *   Jean-Benoit Martin <jean-benoit.martin@open.eurogiciel.org>
+ *
+ */
+#define _GNU_SOURCE
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+
+#include "tzplatform_variables.h"
+#include "tzplatform_config.h"
+#include "scratch.h"
+#include "arena.h"
+
+#ifndef ARENA_CHUNK_SIZE
+#define ARENA_CHUNK_SIZE      4000
+#endif
+
+#if ARENA_CHUNK_SIZE <= 0
+#error "bad value for ARENA_CHUNK_SIZE"
+#endif
+
+/* add to the 'arena' a chunk of at least 'size' bytes */
+static struct arena_chunk *addchunk( struct tzplatform_arena *arena, size_t size)
+{
+    struct arena_chunk *chunk;
+
+    if (size < ARENA_CHUNK_SIZE)
+        size = ARENA_CHUNK_SIZE;
+    chunk = malloc( size + sizeof * chunk);
+    if (chunk != NULL) {
+        chunk->next = arena->chunks;
+        chunk->size = size;
+        chunk->used = 0;
+        arena->chunks = chunk;
+    }
+    return chunk;
+}
+
+const char *arenacat( struct tzplatform_arena *arena, int ispath, const char **strings)
+{
+    struct arena_chunk *chunk;
+    char *result;
+    size_t length, room;
+
+    /* try to copy in the room of the current chunk */
+    chunk = arena->chunks;
+    if (chunk != NULL) {
+        room = chunk->size - chunk->used;
+        result = (char*)(chunk + 1) + chunk->used;
+        length = scratchcpy( ispath, strings, result, room);
+        if (length < room) {
+            chunk->used += length + 1;
+            return result;
+        }
+    }
+    else
+        length = scratchcpy( ispath, strings, NULL, 0);
+
+    /* not enough room, copy in a new chunk */
+    chunk = addchunk( arena, length + 1);
+    if (chunk == NULL)
+        return NULL;
+    result = (char*)(chunk + 1);
+    scratchcpy( ispath, strings, result, length + 1);
+    chunk->used = length + 1;
+    return result;
+}
+
+/*************** PUBLIC API begins here **************/
+
+int tzplatform_arena_create(struct tzplatform_arena **result)
+{
+    struct tzplatform_arena *arena;
+
+    arena = malloc( sizeof * arena);
+    *result = arena;
+    if (arena == NULL)
+        return -1;
+    arena->chunks = NULL;
+    return 0;
+}
+
+void tzplatform_arena_reset(struct tzplatform_arena *arena)
+{
+    struct arena_chunk *chunk, *next;
+
+    /* keep the current chunk for the next strings */
+    chunk = arena->chunks;
+    if (chunk != NULL) {
+        next = chunk->next;
+        chunk->next = NULL;
+        chunk->used = 0;
+        while (next != NULL) {
+            chunk = next;
+            next = chunk->next;
+            free( chunk);
+        }
+    }
+}
+
+void tzplatform_arena_destroy(struct tzplatform_arena *arena)
+{
+    struct arena_chunk *chunk, *next;
+
+    next = arena->chunks;
+    while (next != NULL) {
+        chunk = next;
+        next = chunk->next;
+        free( chunk);
+    }
+    free( arena);
+}
+
@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2013-2014 Intel Corporation.
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Authors:
+ *   José Bollo <jose.bollo@open.eurogiciel.org>
+ *   Stéphane Desneux <stephane.desneux@open.eurogiciel.org>
+ *   Jean-Benoit Martin <jean-benoit.martin@open.eurogiciel.org>
+ *
+ */
+#ifndef TIZEN_PLATFORM_WRAPPER_ARENA_H
+#define TIZEN_PLATFORM_WRAPPER_ARENA_H
+
+/*
+ An arena records strings in chunks of memory that are all released
+ together by tzplatform_arena_reset or tzplatform_arena_destroy.
+*/
+
+/* chunk of the arena */
+struct arena_chunk {
+    struct arena_chunk *next;     /* the previous chunk */
+    size_t size;                  /* size of the data of the chunk */
+    size_t used;                  /* used size of the data of the chunk */
+};
+
+/* the arena */
+struct tzplatform_arena {
+    struct arena_chunk *chunks;   /* the chunks, current chunk first */
+};
+
+/*
+ Return a string of the 'arena' containing the concatenation of the
+ 'strings' as scratchcat does. The returned string is valid until the
+ reset or the destruction of the 'arena'.
+
+ Can return NULL in case of internal error (memory depletion).
+*/
+const char *arenacat( struct tzplatform_arena *arena, int ispath, const char **strings);
+
+#endif
+
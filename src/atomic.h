@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2013-2014 Intel Corporation.
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Authors:
+ *   José Bollo <jose.bollo@open.eurogiciel.org>
+ *   Stéphane Desneux <stephane.desneux@open.eurogiciel.org>
+ *   Jean-Benoit Martin <jean-benoit.martin@open.eurogiciel.org>
+ *
+ */
+#ifndef ATOMIC_H
+#define ATOMIC_H
+
+/* atomic accesses with sequential consistency */
+#ifndef NOT_MULTI_THREAD_SAFE
+#define _ATOMIC_GET_(p)    __atomic_load_n((p), __ATOMIC_SEQ_CST)
+#define _ATOMIC_SET_(p,v)  __atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+#define _ATOMIC_INC_(p)    __atomic_add_fetch((p), 1, __ATOMIC_SEQ_CST)
+#define _ATOMIC_DEC_(p)    __atomic_sub_fetch((p), 1, __ATOMIC_SEQ_CST)
+#else
+#define _ATOMIC_GET_(p)    (*(p))
+#define _ATOMIC_SET_(p,v)  (*(p) = (v))
+#define _ATOMIC_INC_(p)    (++*(p))
+#define _ATOMIC_DEC_(p)    (--*(p))
+#endif
+
+/* atomic accesses without ordering, for counters read by other threads */
+#ifndef NOT_MULTI_THREAD_SAFE
+#define _RELAXED_GET_(p)   __atomic_load_n((p), __ATOMIC_RELAXED)
+#define _RELAXED_SET_(p,v) __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#else
+#define _RELAXED_GET_(p)   (*(p))
+#define _RELAXED_SET_(p,v) (*(p) = (v))
+#endif
+
+#endif
+
@@ -37,7 +37,7 @@
 
 #include "buffer.h"
 
-static int buffread( struct buffer *buffer, int fd)
+int buffer_read( struct buffer *buffer, int fd)
 {
     const int size = 4096;
     void *p;
@@ -61,7 +61,7 @@ static int buffread( struct buffer *buffer, int fd)
             return 0;
         }
         if (status > 0) {
-            length = length + (int)status;
+            length = length + (size_t)status;
         }
         else if (errno != EAGAIN && errno != EINTR) {
             free( memory);
@@ -70,39 +70,61 @@ static int buffread( struct buffer *buffer, int fd)
     }
 }
 
-int buffer_create( struct buffer *buffer, const char *pathname)
+int buffer_map( struct buffer *buffer, int fd)
 {
-    int fd, result;
+    int result;
     struct stat bstat;
     void *memory;
     size_t length;
 
-    result = open(pathname, O_RDONLY);
-    if (result >= 0)
+    result = fstat(fd, &bstat);
+    if (result == 0)
     {
-        fd = result;
-        result = fstat(fd, &bstat);
-        if (result == 0)
+        length = (size_t)bstat.st_size;
+        if (!S_ISREG(bstat.st_mode))
         {
-            length = (size_t)bstat.st_size;
-            if (bstat.st_size != (off_t)length)
-            {
-                errno = EOVERFLOW;
-                result = -1;
+            errno = ENODEV;
+            result = -1;
+        }
+        else if (bstat.st_size != (off_t)length)
+        {
+            errno = EOVERFLOW;
+            result = -1;
+        }
+        else if (length == 0)
+        {
+            buffer->buffer = NULL;
+            buffer->length = 0;
+            buffer->mapped = 0;
+        }
+        else
+        {
+            memory = mmap(NULL,length,PROT_READ,MAP_PRIVATE,fd,0);
+            if (memory != MAP_FAILED) {
+                buffer->buffer = memory;
+                buffer->length = length;
+                buffer->mapped = 1;
             }
-            else
-            {
-                memory = mmap(NULL,length,PROT_READ,MAP_PRIVATE,fd,0);
-                if (memory != MAP_FAILED) {
-                    buffer->buffer = memory;
-                    buffer->length = length;
-                    buffer->mapped = 1;
-                }
-                else {
-                    result = buffread( buffer, fd);
-                }
+            else {
+                result = -1;
             }
         }
+    }
+    return result;
+}
+
+int buffer_create( struct buffer *buffer, const char *pathname)
+{
+    int fd, result;
+
+    result = open(pathname, O_RDONLY);
+    if (result >= 0)
+    {
+        fd = result;
+        result = buffer_map( buffer, fd);
+        if (result != 0)
+            /* pipes and devices are read */
+            result = buffer_read( buffer, fd);
         close(fd);
     }
     return result;
@@ -32,11 +32,26 @@ struct buffer {
 };
 
 /*
-   Create the 'buffer' from reading content of the file of 'pathname'.
+   Create the 'buffer' from the content of the file of 'pathname'.
+   The content is mapped when possible or else read (pipes, devices).
    Returns 0 if success, -1 if error occured (see then errno)
 */
 int buffer_create( struct buffer *buffer, const char *pathname);
 
+/*
+   Create the 'buffer' from reading until its end the file opened
+   as 'fd' that isn't closed.
+   Returns 0 if success, -1 if error occured (see then errno)
+*/
+int buffer_read( struct buffer *buffer, int fd);
+
+/*
+   Create the 'buffer' from mapping the content of the file opened
+   as 'fd' that isn't closed.
+   Returns 0 if success, -1 if error occured (see then errno)
+*/
+int buffer_map( struct buffer *buffer, int fd);
+
 /*
    Destroy the 'buffer'.
    Returns 0 if success, -1 if error occured (see then errno)
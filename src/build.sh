@@ -2,19 +2,20 @@
 
 # useful build script for purpose of testing
 
-f="-O -Wall -DCONFIGPATH=\"meta\" -fPIC"
+f="-O -Wall -DCONFIGPATH=\"meta\" -fPIC -fgnu89-inline -I."
 
 e() { echo error: "$@" >&2; exit 1; }
 d() { echo running: "$@" >&2; "$@" || e "$@"; }
 
 [ -f meta ] || e no file meta
 
-d gcc $f -o toolbox toolbox.c parser.c buffer.c foreign.c sha256sum.c
+d gcc $f -o toolbox toolbox.c parser.c buffer.c foreign.c heap.c image.c sha256sum.c
 d ./toolbox h > tzplatform_variables.h
 d ./toolbox c > hash.inc
 d ./toolbox signup > signup.inc
+d ./toolbox image > meta.bin
 d gcc $f -c *.c
-d ld -shared --version-script=tzplatform_config.sym -o libtzplatform-shared.so buffer.o   foreign.o  heap.o  parser.o  scratch.o context.o  hashing.o  init.o  passwd.o  shared-api.o
+d ld -shared --version-script=tzplatform_config.sym -o libtzplatform-shared.so arena.o buffer.o   foreign.o  heap.o  parser.o  scratch.o cache.o context.o  hashing.o  image.o  init.o  passwd.o  shared-api.o  users.o
 d ar cr libtzplatform-static.a static-api.o isadmin.o
 d gcc -o get tzplatform_get.o static-api.o -L. -ltzplatform-static -ltzplatform-shared
 
@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2013-2014 Intel Corporation.
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Authors:
+ *   José Bollo <jose.bollo@open.eurogiciel.org>
+ *   Stéphane Desneux <stephane.desneux@open.eurogiciel.org>
+ *   Jean-Benoit Martin <jean-benoit.martin@open.eurogiciel.org>
+ *
+ */
+#define _GNU_SOURCE
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <string.h>
+#include <unistd.h>
+
+#ifndef NOT_MULTI_THREAD_SAFE
+#include <pthread.h>
+#endif
+
+#include "tzplatform_variables.h"
+#include "tzplatform_config.h"
+#include "heap.h"
+#include "buffer.h"
+#include "foreign.h"
+#include "atomic.h"
+#include "context.h"
+#include "cache.h"
+
+#ifndef CACHE_MAXIMUM_COUNT
+#define CACHE_MAXIMUM_COUNT   8
+#endif
+
+#ifndef CACHE_MAXIMUM_SIZE
+#define CACHE_MAXIMUM_SIZE    262144
+#endif
+
+#if CACHE_MAXIMUM_COUNT <= 0
+#error "bad value for CACHE_MAXIMUM_COUNT"
+#endif
+
+/* the recorded snapshots, the most recently used first */
+static struct tzplatform_snapshot *entries[CACHE_MAXIMUM_COUNT];
+static int count = 0;
+static size_t size = 0;
+static unsigned long hits = 0, misses = 0;
+
+#ifndef NOT_MULTI_THREAD_SAFE
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/* locks the cache */
+inline static void lock()
+{
+#ifndef NOT_MULTI_THREAD_SAFE
+    pthread_mutex_lock( &mutex);
+#endif
+}
+
+/* unlock the cache */
+inline static void unlock()
+{
+#ifndef NOT_MULTI_THREAD_SAFE
+    pthread_mutex_unlock( &mutex);
+#endif
+}
+
+/* size in bytes of the 'snapshot' */
+static size_t snapshot_size( struct tzplatform_snapshot *snapshot)
+{
+    return sizeof * snapshot + snapshot->heap.capacity;
+}
+
+/* removes the entry of 'index' */
+static void drop( int index)
+{
+    struct tzplatform_snapshot *snapshot = entries[index];
+
+    size -= snapshot_size( snapshot);
+    count--;
+    memmove( &entries[index], &entries[index + 1],
+                        (size_t)(count - index) * sizeof * entries);
+    snapshot_unref( snapshot);
+}
+
+/* search the index of the entry for 'ids' or -1 */
+static int search( const struct ids *ids)
+{
+    int index;
+
+    for (index = 0 ; index < count ; index++)
+        if (entries[index]->ids.uid == ids->uid
+                && entries[index]->ids.euid == ids->euid
+                && entries[index]->ids.gid == ids->gid
+                && entries[index]->ids.users == ids->users)
+            return index;
+    return -1;
+}
+
+/* return the snapshot for 'ids' with a new reference or NULL, counting
+   the miss only if 'countmiss' */
+static struct tzplatform_snapshot *lookup( const struct ids *ids,
+                                                            int countmiss)
+{
+    struct tzplatform_snapshot *result;
+    int index;
+
+    lock();
+    index = search( ids);
+    if (index < 0) {
+        result = NULL;
+        if (countmiss)
+            misses++;
+    }
+    else {
+        /* move it at first place */
+        result = entries[index];
+        memmove( &entries[1], &entries[0], (size_t)index * sizeof * entries);
+        entries[0] = result;
+        snapshot_ref( result);
+        hits++;
+    }
+    unlock();
+
+    return result;
+}
+
+struct tzplatform_snapshot *cache_get( const struct ids *ids)
+{
+    return lookup( ids, 1);
+}
+
+struct tzplatform_snapshot *cache_probe( const struct ids *ids)
+{
+    return lookup( ids, 0);
+}
+
+void cache_put( struct tzplatform_snapshot *snapshot)
+{
+    size_t length;
+    int index;
+
+    length = snapshot_size( snapshot);
+    if (length > CACHE_MAXIMUM_SIZE)
+        return;
+
+    lock();
+
+    /* remove the previous entry, the entries computed for other
+       generations of the users and the least recently used entries */
+    index = search( &snapshot->ids);
+    if (index >= 0)
+        drop( index);
+    index = count;
+    while (index)
+        if (entries[--index]->ids.users != snapshot->ids.users)
+            drop( index);
+    while (count == CACHE_MAXIMUM_COUNT || size + length > CACHE_MAXIMUM_SIZE)
+        drop( count - 1);
+
+    /* record at first place */
+    memmove( &entries[1], &entries[0], (size_t)count * sizeof * entries);
+    entries[0] = snapshot;
+    snapshot_ref( snapshot);
+    count++;
+    size += length;
+
+    unlock();
+}
+
+void cache_clear()
+{
+    lock();
+    while (count)
+        drop( count - 1);
+    unlock();
+}
+
+/*************** PUBLIC API begins here **************/
+
+void tzplatform_cache_stats(struct tzplatform_cache_stats *stats)
+{
+    lock();
+    stats->hits = hits;
+    stats->misses = misses;
+    stats->count = (unsigned)count;
+    stats->size = size;
+    unlock();
+}
+
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2013-2014 Intel Corporation.
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Authors:
+ *   José Bollo <jose.bollo@open.eurogiciel.org>
+ *   Stéphane Desneux <stephane.desneux@open.eurogiciel.org>
+ *   Jean-Benoit Martin <jean-benoit.martin@open.eurogiciel.org>
+ *
+ */
+#ifndef TIZEN_PLATFORM_WRAPPER_CACHE_H
+#define TIZEN_PLATFORM_WRAPPER_CACHE_H
+
+#ifndef CONTEXT_H
+#error "you should include context.h"
+#endif
+
+/*
+ The cache records the most recently computed snapshots by ids.
+ It is bounded in count of snapshots and in bytes. As the ids include
+ the generation of the users, the snapshots computed before a change
+ of the users are no more found and are removed by the next put.
+*/
+
+/*
+   Return the snapshot recorded for 'ids' with a new reference
+   or NULL if there isn't such snapshot.
+*/
+struct tzplatform_snapshot *cache_get( const struct ids *ids);
+
+/*
+   Same as cache_get but a missing snapshot isn't counted as a miss,
+   for the searches that are followed by a cache_get when they fail.
+*/
+struct tzplatform_snapshot *cache_probe( const struct ids *ids);
+
+/*
+   Record the 'snapshot' in the cache that gets a reference to it.
+*/
+void cache_put( struct tzplatform_snapshot *snapshot);
+
+/*
+   Removes all the snapshots recorded in the cache.
+*/
+void cache_clear();
+
+#endif
+
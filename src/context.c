@@ -30,6 +30,7 @@
 # include "config.h"
 #endif
 
+#include <stdlib.h>
 #include <unistd.h>
 
 #ifndef NOT_MULTI_THREAD_SAFE
@@ -38,8 +39,11 @@
 
 #include "tzplatform_variables.h"
 #include "heap.h"
+#include "buffer.h"
 #include "foreign.h"
+#include "atomic.h"
 #include "context.h"
+#include "passwd.h"
 
 
 inline uid_t get_uid(struct tzplatform_context *context)
@@ -53,6 +57,43 @@ inline uid_t get_uid(struct tzplatform_context *context)
     return result;
 }
 
+void get_ids(struct tzplatform_context *context, struct ids *ids)
+{
+    ids->uid = get_uid( context);
+    ids->euid = context->user == _USER_NOT_SET_ ? geteuid() : context->user;
+    ids->gid = getgid();
+    ids->users = pw_generation();
+}
+
+void base_ref(struct base *base)
+{
+    _ATOMIC_INC_( &base->refcount);
+}
+
+void base_unref(struct base *base)
+{
+    if (_ATOMIC_DEC_( &base->refcount) == 0) {
+        heap_destroy( &base->heap);
+        if (base->image.buffer != NULL)
+            buffer_destroy( &base->image);
+        free( base);
+    }
+}
+
+void snapshot_ref(struct tzplatform_snapshot *snapshot)
+{
+    _ATOMIC_INC_( &snapshot->refcount);
+}
+
+void snapshot_unref(struct tzplatform_snapshot *snapshot)
+{
+    if (_ATOMIC_DEC_( &snapshot->refcount) == 0) {
+        heap_destroy( &snapshot->heap);
+        base_unref( snapshot->base);
+        free( snapshot);
+    }
+}
+
 #if _FOREIGN_HAS_(EUID)
 inline uid_t get_euid(struct tzplatform_context *context)
 {
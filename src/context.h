@@ -28,26 +28,94 @@
 #error "you should include heap.h"
 #endif
 
+#ifndef BUFFER_H
+#error "you should include buffer.h"
+#endif
+
 #ifndef FOREIGN_H
 #error "you should include foreign.h"
 #endif
 
+#ifndef ATOMIC_H
+#error "you should include atomic.h"
+#endif
+
 enum STATE { RESET=0, ERROR, VALID };
 
 #define _USER_NOT_SET_  ((uid_t)-1)
 
+/* the ids used for computing the values */
+struct ids {
+    uid_t uid;
+    uid_t euid;
+    gid_t gid;
+    unsigned long users;    /* generation of the users (pw_generation) */
+};
+
+/*
+ The values read from the config file (or from its image). They don't
+ depend on the user: the dependant values are templates where the
+ foreign variables are not yet solved (see image.h).
+*/
+struct base {
+    int refcount;
+    struct heap heap;
+    struct buffer image;
+    const char *values[_TZPLATFORM_VARIABLES_COUNT_];
+    char dependant[_TZPLATFORM_VARIABLES_COUNT_];
+};
+
+/* the read only values computed by 'initialize' for some ids */
+struct tzplatform_snapshot {
+    int refcount;
+    struct ids ids;
+    struct base *base;
+    struct heap heap;   /* the dependant values */
+    const char *values[_TZPLATFORM_VARIABLES_COUNT_];
+    /* the unique copies of the values made by scratchcat, recorded when
+       first asked and only valid if 'generation' is the current
+       generation of the scratch strings */
+    size_t generation;
+    const char *unique[_TZPLATFORM_VARIABLES_COUNT_];
+    /* the typed values, memoized when first asked: the flags hasint,
+       hasuid and hasgid are set once the values are recorded */
+    char hasint[_TZPLATFORM_VARIABLES_COUNT_];
+    char hasuid[_TZPLATFORM_VARIABLES_COUNT_];
+    char hasgid[_TZPLATFORM_VARIABLES_COUNT_];
+    int ints[_TZPLATFORM_VARIABLES_COUNT_];
+    uid_t uids[_TZPLATFORM_VARIABLES_COUNT_];
+    gid_t gids[_TZPLATFORM_VARIABLES_COUNT_];
+};
+
+/*
+ The values of the context are read without locking the mutex:
+ readers count themselves in 'readers' and then use 'snapshot'
+ if it is not NULL. The mutex is only used for the transitions
+ (initialization, reset, change of user) that unpublish the
+ snapshot and wait that 'readers' falls to zero before
+ destroying it.
+*/
 struct tzplatform_context {
 #ifndef NOT_MULTI_THREAD_SAFE
     pthread_mutex_t mutex;
 #endif
     enum STATE state;
     uid_t user;
-    struct heap heap;
-    const char *values[_TZPLATFORM_VARIABLES_COUNT_];
+    int uncached;       /* aren't the snapshots put in the cache? */
+    int readers;
+    struct tzplatform_snapshot *snapshot;
 };
 
 inline uid_t get_uid(struct tzplatform_context *context);
 
+void get_ids(struct tzplatform_context *context, struct ids *ids);
+
+void base_ref(struct base *base);
+void base_unref(struct base *base);
+
+void snapshot_ref(struct tzplatform_snapshot *snapshot);
+void snapshot_unref(struct tzplatform_snapshot *snapshot);
+
 #if _FOREIGN_HAS_(EUID)
 inline uid_t get_euid(struct tzplatform_context *context);
 #endif
@@ -33,6 +33,7 @@
 #include <sys/mman.h>
 
 #include "heap.h"
+#include "atomic.h"
 
 /* align to a size_t size */
 inline static size_t align(size_t size)
@@ -45,12 +46,14 @@ inline static size_t align(size_t size)
 /* align to a page size */
 inline static size_t pagealign( size_t size)
 {
-    static size_t pagemask = 0;
+    static size_t shared_pagemask = 0;
+    size_t pagemask = _RELAXED_GET_(&shared_pagemask);
     /* we assume that pagesize is a power of 2 */
     if (!pagemask) {
 	pagemask = (size_t)sysconf(_SC_PAGE_SIZE) - 1;
 	assert( pagemask );
 	assert( (pagemask & (pagemask+1)) == 0 );
+	_RELAXED_SET_(&shared_pagemask, pagemask);
     }
     return (size + pagemask) & ~pagemask;
 }
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2013-2014 Intel Corporation.
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Authors:
+ *   José Bollo <jose.bollo@open.eurogiciel.org>
+ *   Stéphane Desneux <stephane.desneux@open.eurogiciel.org>
+ *   Jean-Benoit Martin <jean-benoit.martin@open.eurogiciel.org>
+ *
+ */
+#define _GNU_SOURCE
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdint.h>
+#include <string.h>
+
+#include "image.h"
+
+int image_check( const char *data, size_t length,
+                                    uint32_t count, const char signup[32])
+{
+    const struct image_header *header;
+    const struct image_entry *entry, *end;
+    const char *pool;
+    size_t size;
+
+    /* check the header */
+    if (length < sizeof * header)
+        return -1;
+    header = (const struct image_header *)data;
+    if (memcmp( header->magic, IMAGE_MAGIC, sizeof header->magic)
+            || header->version != IMAGE_VERSION
+            || header->count != count
+            || memcmp( header->signup, signup, sizeof header->signup))
+        return -1;
+
+    /* check the size */
+    size = sizeof * header + count * sizeof * entry + header->poolsize;
+    if (length != size)
+        return -1;
+
+    /* check the entries */
+    pool = image_pool( data);
+    entry = image_entries( data);
+    end = entry + count;
+    while (entry != end) {
+        if (entry->offset >= header->poolsize
+                || entry->length >= header->poolsize - entry->offset
+                || pool[entry->offset + entry->length] != 0)
+            return -1;
+        entry++;
+    }
+    return 0;
+}
+
+
+uint64_t image_hash( const char *data, size_t length)
+{
+    uint64_t hash;
+
+    /* FNV-1a */
+    hash = UINT64_C(14695981039346656037);
+    while (length != 0) {
+        hash ^= (unsigned char)*data++;
+        hash *= UINT64_C(1099511628211);
+        length--;
+    }
+    return hash;
+}
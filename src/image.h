@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2013-2014 Intel Corporation.
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Authors:
+ *   José Bollo <jose.bollo@open.eurogiciel.org>
+ *   Stéphane Desneux <stephane.desneux@open.eurogiciel.org>
+ *   Jean-Benoit Martin <jean-benoit.martin@open.eurogiciel.org>
+ *
+ */
+#ifndef TIZEN_PLATFORM_WRAPPER_IMAGE_H
+#define TIZEN_PLATFORM_WRAPPER_IMAGE_H
+
+/*
+ The binary image is a precompiled form of the config file that is
+ produced by the command 'image' of the tool. It is made of a header,
+ followed by one entry per variable (in the order of the enumeration)
+ and then by the pool of the null terminated strings of the values.
+
+ It doesn't contain any pointer and can be used directly after being
+ mapped in memory.
+
+ The values of the variables that depend on foreign variables (HOME,
+ USER, ...) are templates where each reference to a foreign variable
+ is written IMAGE_FOREIGN_BEGIN name IMAGE_FOREIGN_END.
+
+ The image records the size and the hash of the content of the config
+ file it was made from. It is not tied to the inode nor to the dates
+ of the file and can be produced at build time or on another system.
+*/
+
+#define IMAGE_MAGIC           "TZPCIMG"  /* with the terminating null: 8 bytes */
+#define IMAGE_VERSION         2
+
+#define IMAGE_DEPENDANT       1          /* flag of dependant values */
+
+#define IMAGE_FOREIGN_BEGIN   '\001'
+#define IMAGE_FOREIGN_END     '\002'
+
+/* header of the image */
+struct image_header {
+    char     magic[8];       /* IMAGE_MAGIC */
+    uint32_t version;        /* IMAGE_VERSION */
+    uint32_t count;          /* count of variables */
+    uint64_t confsize;       /* size of the config file */
+    uint64_t confhash;       /* image_hash of the config file */
+    char     signup[32];     /* signup of the names of the variables */
+    uint32_t poolsize;       /* size of the pool of strings */
+    uint32_t reserved;
+};
+
+/* entry of the image */
+struct image_entry {
+    uint32_t offset;         /* offset of the value within the pool */
+    uint32_t length;         /* length of the value without terminating null */
+    uint32_t flags;          /* IMAGE_DEPENDANT or 0 */
+};
+
+/*
+   Check that the 'length' bytes of 'data' are a valid image
+   for 'count' variables of the given 'signup'.
+   Returns 0 if valid or -1 if not valid.
+*/
+int image_check( const char *data, size_t length,
+                                    uint32_t count, const char signup[32]);
+
+/*
+   Return the hash of the 'length' bytes of 'data'.
+*/
+uint64_t image_hash( const char *data, size_t length);
+
+/*
+   Return the entries of the image of 'data'.
+*/
+inline static const struct image_entry *image_entries( const char *data)
+{
+    return (const struct image_entry *)
+                        (data + sizeof(struct image_header));
+}
+
+/*
+   Return the pool of strings of the image of 'data'.
+*/
+inline static const char *image_pool( const char *data)
+{
+    const struct image_header *header = (const struct image_header *)data;
+    return (const char *)(image_entries( data) + header->count);
+}
+
+#endif
+
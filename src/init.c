@@ -35,6 +35,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <ctype.h>
 #include <stdarg.h>
 #include <alloca.h>
@@ -49,18 +50,28 @@
 #define CONFIGPATH "/etc/tizen-platform.conf"
 #endif
 
+#ifndef CONFIGIMAGEPATH
+#define CONFIGIMAGEPATH CONFIGPATH ".bin"
+#endif
+
 #include "tzplatform_variables.h"
 #include "tzplatform_config.h"
 #include "parser.h"
 #include "heap.h"
 #include "buffer.h"
 #include "foreign.h"
+#include "image.h"
 #include "scratch.h"
 #include "passwd.h"
+#include "atomic.h"
 #include "context.h"
+#include "cache.h"
 #include "hashing.h"
 #include "init.h"
 
+/* the signup of names */
+#include "signup.inc"
+
 #define _HAS_IDS_   (  _FOREIGN_HAS_(UID)  \
                     || _FOREIGN_HAS_(EUID) \
                     || _FOREIGN_HAS_(GID)  )
@@ -72,14 +83,25 @@
 
 /* local and static variables */
 static const char metafilepath[] = CONFIGPATH;
+static const char imagefilepath[] = CONFIGIMAGEPATH;
 static const char emptystring[] = "";
 
+/* the values read from the config file */
+static struct base *global_base = NULL;
+#ifndef NOT_MULTI_THREAD_SAFE
+static pthread_mutex_t base_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
 /* structure for reading config files */
 struct reading {
     int errcount;
     struct tzplatform_context *context;
+    struct tzplatform_snapshot *snapshot;
+    struct base *base;
     size_t dynvars[_FOREIGN_COUNT_];
+    char undefined[_FOREIGN_COUNT_];
     size_t offsets[_TZPLATFORM_VARIABLES_COUNT_];
+    char template[8];
 };
 
 /* write the error message */
@@ -105,7 +127,7 @@ static void foreignid( struct reading *reading)
     if (reading->dynvars[UID] == HNULL) {
         n = snprintf( buffer, sizeof buffer, "%d", (int)get_uid(reading->context));
         if (0 < n && n < (int)(sizeof buffer))
-            reading->dynvars[UID] = heap_strndup( &reading->context->heap, buffer, (size_t)n);
+            reading->dynvars[UID] = heap_strndup( &reading->snapshot->heap, buffer, (size_t)n);
     }
 #endif
 
@@ -114,7 +136,7 @@ static void foreignid( struct reading *reading)
     if (reading->dynvars[EUID] == HNULL) {
         n = snprintf( buffer, sizeof buffer, "%d", (int)get_euid(reading->context));
         if (0 < n && n < (int)(sizeof buffer))
-            reading->dynvars[EUID] = heap_strndup( &reading->context->heap, buffer, (size_t)n);
+            reading->dynvars[EUID] = heap_strndup( &reading->snapshot->heap, buffer, (size_t)n);
     }
 #endif
 
@@ -123,7 +145,7 @@ static void foreignid( struct reading *reading)
     if (reading->dynvars[GID] == HNULL) {
         n = snprintf( buffer, sizeof buffer, "%d", (int)get_gid(reading->context));
         if (0 < n && n < (int)(sizeof buffer))
-            reading->dynvars[GID] = heap_strndup( &reading->context->heap, buffer, (size_t)n);
+            reading->dynvars[GID] = heap_strndup( &reading->snapshot->heap, buffer, (size_t)n);
     }
 #endif
 }
@@ -188,21 +210,21 @@ static void foreignpw( struct reading *reading)
 
     if (n) {
         array[n] = NULL;
-        if (pw_get( &reading->context->heap, array) == 0) {
+        if (pw_get( &reading->snapshot->heap, array) == 0) {
 #if _FOREIGN_HAS_(HOME)
-            if (uid.set)
+            if (uid.set && reading->dynvars[HOME] == HNULL)
                 reading->dynvars[HOME] = uid.home;
 #endif
 #if _FOREIGN_HAS_(USER)
-            if (uid.set)
+            if (uid.set && reading->dynvars[USER] == HNULL)
                 reading->dynvars[USER] = uid.user;
 #endif
 #if _FOREIGN_HAS_(EHOME)
-            if (euid.set)
+            if (euid.set && reading->dynvars[EHOME] == HNULL)
                 reading->dynvars[EHOME] = euid.home;
 #endif
 #if _FOREIGN_HAS_(EUSER)
-            if (euid.set)
+            if (euid.set && reading->dynvars[EUSER] == HNULL)
                 reading->dynvars[EUSER] = euid.user;
 #endif
         }
@@ -253,7 +275,7 @@ static const char *foreignvar( struct reading *reading,
         return NULL;
     }
     offset = reading->dynvars[key];
-    return offset==HNULL ? NULL : heap_address( &reading->context->heap, offset);
+    return offset==HNULL ? NULL : heap_address( &reading->snapshot->heap, offset);
 }
 
 /* callback for parsing errors */
@@ -291,13 +313,21 @@ static const char *getcb( struct parsing *parsing,
         /* found: try to use it */
         offset = reading->offsets[id];
         if (offset != HNULL)
-            result = heap_address( &reading->context->heap, offset);
+            result = heap_address( &reading->base->heap, offset);
         else 
             result = NULL;
     }
+    else if (foreign( key, length) != _FOREIGN_INVALID_
+                        && length + 3 <= sizeof reading->template) {
+        /* that is a foreign variable: solved later for the user */
+        reading->template[0] = IMAGE_FOREIGN_BEGIN;
+        memcpy( &reading->template[1], key, length);
+        reading->template[length + 1] = IMAGE_FOREIGN_END;
+        reading->template[length + 2] = 0;
+        result = reading->template;
+    }
     else {
-        /* that is a foreign variable */
-        result = foreignvar( reading, key, length);
+        result = NULL;
     }
 
     /* emit the error and then return */
@@ -336,7 +366,7 @@ static int putcb( struct parsing *parsing,
         }
 
         /* allocate the variable value */
-        offset = heap_alloc( &reading->context->heap, value_length+1);
+        offset = heap_alloc( &reading->base->heap, value_length+1);
         if (offset == HNULL) {
             /* error of allocation */
             reading->errcount++;
@@ -345,9 +375,11 @@ static int putcb( struct parsing *parsing,
         else {
             /* record the variable value */
             reading->offsets[id] = offset;
-            string = heap_address( &reading->context->heap, offset);
+            string = heap_address( &reading->base->heap, offset);
             memcpy( string, value, value_length);
             string[value_length] = 0;
+            reading->base->dependant[id] =
+                    memchr( value, IMAGE_FOREIGN_BEGIN, value_length) != NULL;
         }
     }
     else {
@@ -362,70 +394,422 @@ static int putcb( struct parsing *parsing,
     return 0;
 }
 
-/* initialize the environment */
-inline void initialize(struct tzplatform_context *context)
+/* get the value of the foreign variable of the template at 'head' */
+static const char *templatevar( struct reading *reading, const char **head)
 {
-    struct buffer buffer;
-    struct parsing parsing;
-    struct reading reading;
-    size_t offset;
+    const char *name, *end, *result;
+    enum fkey key;
+
+    name = *head + 1;
+    end = strchr( name, IMAGE_FOREIGN_END);
+    if (end == NULL) {
+        end = name + strlen( name);
+        *head = end;
+    }
+    else
+        *head = end + 1;
+
+    /* as when parsing, an undefined value is empty and reported once,
+       it is then no more searched so that it keeps its length */
+    key = foreign( name, (size_t)(end - name));
+    if (key != _FOREIGN_INVALID_ && reading->undefined[key])
+        return emptystring;
+    result = foreignvar( reading, name, (size_t)(end - name));
+    if (result == NULL) {
+        if (key != _FOREIGN_INVALID_)
+            reading->undefined[key] = 1;
+        reading->errcount++;
+        writerror( "undefined value for %.*s", (int)(end - name), name);
+        result = emptystring;
+    }
+    return result;
+}
+
+/* instanciate in the heap of the snapshot the 'template' */
+static size_t instanciate( struct reading *reading, const char *template)
+{
+    const char *head, *value;
+    char *string;
+    size_t length, offset;
+
+    /* compute the length (it also solves the foreign variables) */
+    length = 0;
+    head = template;
+    while (*head) {
+        if (*head != IMAGE_FOREIGN_BEGIN) {
+            head++;
+            length++;
+        }
+        else
+            length += strlen( templatevar( reading, &head));
+    }
+
+    /* allocate the value */
+    offset = heap_alloc( &reading->snapshot->heap, length + 1);
+    if (offset == HNULL) {
+        reading->errcount++;
+        writerror( "out of memory");
+        return HNULL;
+    }
+
+    /* copy the value */
+    string = heap_address( &reading->snapshot->heap, offset);
+    head = template;
+    while (*head) {
+        if (*head != IMAGE_FOREIGN_BEGIN)
+            *string++ = *head++;
+        else {
+            value = templatevar( reading, &head);
+            length = strlen( value);
+            memcpy( string, value, length);
+            string += length;
+        }
+    }
+    *string = 0;
+    return offset;
+}
+
+/* read the binary image if it is valid for the 'length' bytes of 'conf' */
+static int readimage( struct reading *reading, const char *conf, size_t length)
+{
+    struct base *base = reading->base;
+    struct buffer *image = &base->image;
+    const struct image_header *header;
+    const struct image_entry *entries;
+    const char *pool;
     int i, result;
 
-    /* clear the variables */
-    reading.errcount = 0;
-    reading.context = context;
-    for (i = 0 ; i < (int)_FOREIGN_COUNT_ ; i++) {
-        reading.dynvars[i] = HNULL;
+    /* map the image */
+    result = buffer_create( image, imagefilepath);
+    if (result != 0)
+        return result;
+
+    /* check it is valid and made from the content of the config file */
+    header = (const struct image_header *)image->buffer;
+    if (image_check( image->buffer, image->length,
+                            (uint32_t)_TZPLATFORM_VARIABLES_COUNT_,
+                            tizen_platform_config_signup + 1) != 0
+            || header->confsize != (uint64_t)length
+            || header->confhash != image_hash( conf, length)) {
+        buffer_destroy( image);
+        image->buffer = NULL;
+        return -1;
     }
+
+    /* set the values */
+    entries = image_entries( image->buffer);
+    pool = image_pool( image->buffer);
     for (i = 0 ; i < (int)_TZPLATFORM_VARIABLES_COUNT_ ; i++) {
-        context->values[i] = NULL;
-        reading.offsets[i] = HNULL;
+        base->values[i] = pool + entries[i].offset;
+        base->dependant[i] = (entries[i].flags & IMAGE_DEPENDANT) != 0;
     }
+    return 0;
+}
 
-    /* read the configuration file */
-    result = buffer_create( &buffer, metafilepath);
-    if (result != 0) {
-        writerror( "can't read file %s",metafilepath);
-        context->state = ERROR;
-        return;
-    }
+/* read the values of the config file, independently of the user */
+static struct base *readbase()
+{
+    struct buffer buffer;
+    struct parsing parsing;
+    struct reading reading;
+    struct base *base;
+    size_t offset;
+    int i, fd, result;
 
-    /* create the heap */
-    result = heap_create( &context->heap, 1);
+    /* create the base */
+    base = malloc( sizeof * base);
+    if (base == NULL) {
+        writerror( "out of memory");
+        return NULL;
+    }
+    base->refcount = 1;
+    base->image.buffer = NULL;
+    result = heap_create( &base->heap, 1);
     if (result != 0) {
-        buffer_destroy( &buffer);
+        free( base);
         writerror( "out of memory");
-        context->state = ERROR;
-        return;
+        return NULL;
+    }
+
+    /* clear the variables */
+    reading.errcount = 0;
+    reading.context = NULL;
+    reading.snapshot = NULL;
+    reading.base = base;
+    for (i = 0 ; i < (int)_TZPLATFORM_VARIABLES_COUNT_ ; i++) {
+        base->values[i] = NULL;
+        base->dependant[i] = 0;
+        reading.offsets[i] = HNULL;
     }
 
     /* read the file */
-    parsing.buffer = buffer.buffer;
-    parsing.length = buffer.length;
     parsing.maximum_data_size = 0;
     parsing.should_escape = 0;
     parsing.data = &reading;
     parsing.get = getcb;
     parsing.put = putcb;
     parsing.error = errcb;
-    result = parse_utf8_config( &parsing);
-    buffer_destroy( &buffer);
+    fd = open( metafilepath, O_RDONLY|O_CLOEXEC);
+    if (fd < 0) {
+        heap_destroy( &base->heap);
+        free( base);
+        writerror( "can't read file %s",metafilepath);
+        return NULL;
+    }
+    result = buffer_map( &buffer, fd);
+    if (result == 0) {
+        /* use the precompiled image when possible */
+        result = readimage( &reading, buffer.buffer, buffer.length);
+        if (result != 0) {
+            parsing.buffer = buffer.buffer;
+            parsing.length = buffer.length;
+            result = parse_utf8_config( &parsing);
+        }
+        buffer_destroy( &buffer);
+    }
+    else {
+        /* the file can't be mapped, it is parsed while read */
+        result = parse_utf8_config_fd( &parsing, fd);
+    }
+    close( fd);
     if (result != 0 || reading.errcount != 0) {
         writerror( "%d errors while parsing file %s",
                                             reading.errcount, metafilepath);
     }
 
     /* set the variables */
-    heap_read_only( &context->heap);
+    heap_read_only( &base->heap);
     for (i = 0 ; i < (int)_TZPLATFORM_VARIABLES_COUNT_ ; i++) {
         offset = reading.offsets[i];
         if (offset != HNULL)
-            context->values[i] = heap_address( &context->heap, offset);
-        else
+            base->values[i] = heap_address( &base->heap, offset);
+        else if (base->values[i] == NULL)
             writerror( "the variable %s isn't defined in file %s",
                 keyname(i), metafilepath);
             /* TODO undefined variable */;
     }
+    return base;
+}
+
+/* get the values of the config file with a new reference */
+static struct base *getbase()
+{
+    struct base *result;
+
+#ifndef NOT_MULTI_THREAD_SAFE
+    pthread_mutex_lock( &base_mutex);
+#endif
+    if (global_base == NULL)
+        global_base = readbase();
+    result = global_base;
+    if (result != NULL)
+        base_ref( result);
+#ifndef NOT_MULTI_THREAD_SAFE
+    pthread_mutex_unlock( &base_mutex);
+#endif
+    return result;
+}
+
+/* forget the values of the config file */
+void reset_base()
+{
+    struct base *base;
+
+#ifndef NOT_MULTI_THREAD_SAFE
+    pthread_mutex_lock( &base_mutex);
+#endif
+    base = global_base;
+    global_base = NULL;
+#ifndef NOT_MULTI_THREAD_SAFE
+    pthread_mutex_unlock( &base_mutex);
+#endif
+    if (base != NULL)
+        base_unref( base);
+}
+
+/*
+   Compute the snapshot of the values of 'base' for the 'context' of 'ids'.
+   The foreign variables HOME and USER (and their effective variants)
+   are taken from 'home' and 'user' when not NULL. The snapshot takes
+   the reference of 'base'. Return the snapshot or NULL on error.
+*/
+static struct tzplatform_snapshot *compute( struct tzplatform_context *context,
+            const struct ids *ids, struct base *base,
+            const char *home, const char *user)
+{
+    struct reading reading;
+    struct tzplatform_snapshot *snapshot;
+    size_t offset;
+    int i, result;
+
+    /* create the snapshot */
+    snapshot = malloc( sizeof * snapshot);
+    if (snapshot == NULL) {
+        base_unref( base);
+        writerror( "out of memory");
+        return NULL;
+    }
+    snapshot->refcount = 1;
+    snapshot->ids = *ids;
+    snapshot->base = base;
+    snapshot->generation = scratch_generation();
+    memset( snapshot->unique, 0, sizeof snapshot->unique);
+    memset( snapshot->hasint, 0, sizeof snapshot->hasint);
+    memset( snapshot->hasuid, 0, sizeof snapshot->hasuid);
+    memset( snapshot->hasgid, 0, sizeof snapshot->hasgid);
+    result = heap_create( &snapshot->heap, 1);
+    if (result != 0) {
+        free( snapshot);
+        base_unref( base);
+        writerror( "out of memory");
+        return NULL;
+    }
+
+    /* instanciate the values dependant of the user */
+    reading.errcount = 0;
+    reading.context = context;
+    reading.snapshot = snapshot;
+    reading.base = base;
+    for (i = 0 ; i < (int)_FOREIGN_COUNT_ ; i++) {
+        reading.dynvars[i] = HNULL;
+        reading.undefined[i] = 0;
+    }
+#if _FOREIGN_HAS_(HOME)
+    if (home != NULL)
+        reading.dynvars[HOME] = heap_strdup( &snapshot->heap, home);
+#endif
+#if _FOREIGN_HAS_(USER)
+    if (user != NULL)
+        reading.dynvars[USER] = heap_strdup( &snapshot->heap, user);
+#endif
+#if _FOREIGN_HAS_(EHOME)
+    if (home != NULL)
+        reading.dynvars[EHOME] = heap_strdup( &snapshot->heap, home);
+#endif
+#if _FOREIGN_HAS_(EUSER)
+    if (user != NULL)
+        reading.dynvars[EUSER] = heap_strdup( &snapshot->heap, user);
+#endif
+    for (i = 0 ; i < (int)_TZPLATFORM_VARIABLES_COUNT_ ; i++) {
+        reading.offsets[i] = HNULL;
+        if (base->dependant[i]) {
+            snapshot->values[i] = NULL;
+            reading.offsets[i] = instanciate( &reading, base->values[i]);
+        }
+        else {
+            snapshot->values[i] = base->values[i];
+        }
+    }
+
+    /* set the variables, a dependant value is only missing when out of
+       memory and then the snapshot is dropped */
+    heap_read_only( &snapshot->heap);
+    for (i = 0 ; i < (int)_TZPLATFORM_VARIABLES_COUNT_ ; i++) {
+        offset = reading.offsets[i];
+        if (offset != HNULL)
+            snapshot->values[i] = heap_address( &snapshot->heap, offset);
+        else if (base->dependant[i]) {
+            snapshot_unref( snapshot);
+            return NULL;
+        }
+    }
+    return snapshot;
+}
+
+/* initialize the environment */
+inline void initialize(struct tzplatform_context *context)
+{
+    struct tzplatform_snapshot *snapshot;
+    struct base *base;
+    struct ids ids;
+
+    /* search the snapshot in the cache */
+    get_ids( context, &ids);
+    snapshot = cache_get( &ids);
+    if (snapshot == NULL) {
+        /* compute it from the values independent of the user */
+        base = getbase();
+        snapshot = base == NULL ? NULL
+                        : compute( context, &ids, base, NULL, NULL);
+        if (snapshot == NULL) {
+            context->state = ERROR;
+            return;
+        }
+        if (!context->uncached)
+            cache_put( snapshot);
+    }
+
+    /* publish the snapshot */
+    _ATOMIC_SET_( &context->snapshot, snapshot);
     context->state = VALID;
 }
 
+/* item of the users to prefetch */
+struct prefetched {
+    struct pwget pwget;
+    char id[24];
+};
+
+int prefetch(const uid_t *uids, size_t count,
+                                struct tzplatform_snapshot **snapshots)
+{
+    struct tzplatform_context context;
+    struct prefetched *items;
+    struct pwget **array;
+    struct base *base;
+    struct heap heap;
+    struct ids ids;
+    size_t index;
+    int result;
+
+    for (index = 0 ; index < count ; index++)
+        snapshots[index] = NULL;
+
+    /* search all the users at once */
+    items = malloc( count * sizeof * items);
+    array = malloc( (count + 1) * sizeof * array);
+    if (items == NULL || array == NULL || heap_create( &heap, 1) != 0) {
+        free( items);
+        free( array);
+        writerror( "out of memory");
+        return -1;
+    }
+    for (index = 0 ; index < count ; index++) {
+        snprintf( items[index].id, sizeof items[index].id,
+                                            "%u", (unsigned)uids[index]);
+        items[index].pwget.id = items[index].id;
+        array[index] = &items[index].pwget;
+    }
+    array[count] = NULL;
+    result = pw_get( &heap, array) == 0 ? 0 : -1;
+
+    /* compute the values of the found users */
+    base = result == 0 ? getbase() : NULL;
+    if (base == NULL)
+        result = -1;
+    else {
+        /* the context only serves to get the ids of the user */
+        context.user = _USER_NOT_SET_;
+        get_ids( &context, &ids);
+        for (index = 0 ; index < count ; index++) {
+            if (!items[index].pwget.set || uids[index] == _USER_NOT_SET_)
+                result = -1;
+            else {
+                context.user = uids[index];
+                ids.uid = ids.euid = uids[index];
+                base_ref( base);
+                snapshots[index] = compute( &context, &ids, base,
+                        heap_address( &heap, items[index].pwget.home),
+                        heap_address( &heap, items[index].pwget.user));
+                if (snapshots[index] == NULL)
+                    result = -1;
+            }
+        }
+        base_unref( base);
+    }
+
+    heap_destroy( &heap);
+    free( items);
+    free( array);
+    return result;
+}
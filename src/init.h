@@ -26,5 +26,17 @@
 
 inline void initialize(struct tzplatform_context *context);
 
+void reset_base();
+
+/*
+   Compute in 'snapshots' the snapshots of the values of the 'count'
+   users of 'uids', searched at once in the passwd file. The snapshots
+   of the users that don't exist or whose values can't be computed
+   are NULL. The snapshots aren't put in the cache.
+   Return 0 in case of success or -1 if at least one snapshot is NULL.
+*/
+int prefetch(const uid_t *uids, size_t count,
+                                struct tzplatform_snapshot **snapshots);
+
 #endif
 
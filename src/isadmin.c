@@ -31,32 +31,105 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/types.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #include <grp.h>
 #include <pwd.h>
+#ifndef NOT_MULTI_THREAD_SAFE
+#include <pthread.h>
+#endif
 
 #include "isadmin.h"
 #include "tzplatform_variables.h"
 #include "tzplatform_config.h"
 
-int _has_system_group_static_(uid_t uid) {
+#ifndef ISADMIN_CACHE_SIZE
+#define ISADMIN_CACHE_SIZE  64	/* count of slots of the cache, power of 2 */
+#endif
+
+#if ISADMIN_CACHE_SIZE <= 0 || (ISADMIN_CACHE_SIZE & (ISADMIN_CACHE_SIZE - 1)) != 0
+#error "bad value for ISADMIN_CACHE_SIZE"
+#endif
+
+#define INITIAL_GROUPS  32
+
+#ifndef MAXIMUM_GROUPS
+#define MAXIMUM_GROUPS  65536	/* maximum count of groups of a user */
+#endif
+
+/* identity of a file, to detect its changes */
+struct fileid {
+	dev_t dev;
+	ino_t ino;
+	off_t size;
+	struct timespec mtime;
+};
+
+/* slot of the cache of the results by uid */
+struct slot {
+	int used;	/* is the slot used? */
+	int result;	/* the result for the uid */
+	uid_t uid;	/* the uid */
+};
+
+/* the results for the users, valid while the files don't change */
+static struct slot cache[ISADMIN_CACHE_SIZE];
+static int count = 0;
+static struct fileid groupid, passwdid;
+
+/* count of the times that the cache was emptied */
+static unsigned long epoch = 0;
+
+#ifndef NOT_MULTI_THREAD_SAFE
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/* get the identity 'id' of 'file' and return if it changed */
+static int changed(const char *file, struct fileid *id) {
+	struct stat st;
+	struct fileid nid;
+
+	memset(&nid, 0, sizeof nid);
+	if (stat(file, &st) == 0) {
+		nid.dev = st.st_dev;
+		nid.ino = st.st_ino;
+		nid.size = st.st_size;
+		nid.mtime = st.st_mtim;
+	}
+	if (!memcmp(&nid, id, sizeof nid))
+		return 0;
+	*id = nid;
+	return 1;
+}
+
+/* return the slot of 'uid' in the cache */
+static struct slot *search(uid_t uid) {
+	size_t index = ((size_t)uid * 2654435761u) & (ISADMIN_CACHE_SIZE - 1);
+
+	while (cache[index].used && cache[index].uid != uid)
+		index = (index + 1) & (ISADMIN_CACHE_SIZE - 1);
+	return &cache[index];
+}
+
+/* empty the cache */
+static void forget() {
+	memset(cache, 0, sizeof cache);
+	count = 0;
+	epoch++;
+}
+
+/* compute whether 'uid' is in the admin group, without lock */
+static int compute(uid_t uid) {
 	
 	struct passwd pwd, *userinfo = NULL;
 	struct group grp, *systemgroupinfo = NULL;
 	const char *sysgrpname = NULL;
 	char buf[1024];
-	uid_t myuid = 0;
 	gid_t system_gid = 0;
-	gid_t *groups = NULL;
-	int i, nbgroups = 0;
-	
-	
-	if(uid == -1)
-		/* Get current uid */
-		myuid = getuid();
-	else
-		myuid = uid;
+	gid_t stack[INITIAL_GROUPS], *groups, *newgroups;
+	int i, nbgroups, capacity, result;
 	
 	/* Get the gid of the group named "system" */
 	sysgrpname = tzplatform_getname(TZ_SYS_ADMIN_GROUP);
@@ -74,36 +147,103 @@ int _has_system_group_static_(uid_t uid) {
 	
 	/* Get all the gid of the given uid */
 	
-	getpwuid_r(myuid, &pwd, buf, sizeof(buf), &userinfo);
-	
-	/* Need to call this function now to get the number of group to make the
-	   malloc correctly sized */
-	if (getgrouplist(userinfo->pw_name, userinfo->pw_gid, groups, &nbgroups) != -1) {
-		fprintf( stderr, "isadmin ERROR: cannot get number of groups\n");
-		return -1;
-	}
-	
-	groups = malloc(nbgroups * sizeof (gid_t));
-	if (groups == NULL) {
-		fprintf( stderr, "isadmin ERROR: malloc cannot allocate memory\n");
+	getpwuid_r(uid, &pwd, buf, sizeof(buf), &userinfo);
+	if (userinfo == NULL) {
+		fprintf( stderr, "isadmin ERROR: cannot find user %d\n", (int)uid);
 		return -1;
 	}
 	
-	if (getgrouplist(userinfo->pw_name, userinfo->pw_gid, groups, &nbgroups) == -1) {
-		free(groups);
-		fprintf( stderr, "isadmin ERROR: cannot get groups\n");
-		return -1;
+	/* Get the groups, growing the buffer only if needed */
+	groups = stack;
+	capacity = nbgroups = INITIAL_GROUPS;
+	while (getgrouplist(userinfo->pw_name, userinfo->pw_gid, groups, &nbgroups) == -1) {
+		if (nbgroups <= capacity || nbgroups > MAXIMUM_GROUPS) {
+			fprintf( stderr, "isadmin ERROR: cannot get groups\n");
+			if (groups != stack)
+				free(groups);
+			return -1;
+		}
+		newgroups = realloc(groups == stack ? NULL : groups, nbgroups * sizeof (gid_t));
+		if (newgroups == NULL) {
+			fprintf( stderr, "isadmin ERROR: malloc cannot allocate memory\n");
+			if (groups != stack)
+				free(groups);
+			return -1;
+		}
+		groups = newgroups;
+		capacity = nbgroups;
 	}
 	
 	/* Check if the given uid is in the system group */
 	
+	result = 0;
 	for(i = 0 ; i < nbgroups ; i++) {
 		if(groups[i] == system_gid) {
-			free(groups);
-			return 1;
+			result = 1;
+			break;
+		}
+	}
+	if (groups != stack)
+		free(groups);
+	return result;
+}
+
+int _has_system_group_static_(uid_t uid) {
+	
+	struct slot *slot;
+	uid_t myuid;
+	unsigned long current;
+	int result, found, groupchg, passwdchg;
+	
+	if(uid == -1)
+		/* Get current uid */
+		myuid = getuid();
+	else
+		myuid = uid;
+	
+#ifndef NOT_MULTI_THREAD_SAFE
+	pthread_mutex_lock(&mutex);
+#endif
+	/* Forget the results if the files of the users or groups changed */
+	groupchg = changed("/etc/group", &groupid);
+	passwdchg = changed("/etc/passwd", &passwdid);
+	if (groupchg || passwdchg)
+		forget();
+	
+	slot = search(myuid);
+	found = slot->used;
+	result = slot->result;
+	current = epoch;
+#ifndef NOT_MULTI_THREAD_SAFE
+	pthread_mutex_unlock(&mutex);
+#endif
+	if (found)
+		return result;
+
+	/* The lookups of NSS may be slow: they are done without lock */
+	result = compute(myuid);
+	if (result < 0)
+		return result;
+
+#ifndef NOT_MULTI_THREAD_SAFE
+	pthread_mutex_lock(&mutex);
+#endif
+	/* Record the result unless the files changed meanwhile */
+	if (current == epoch) {
+		if (count >= 3 * ISADMIN_CACHE_SIZE / 4)
+			forget();
+		slot = search(myuid);
+		if (!slot->used) {
+			slot->used = 1;
+			slot->uid = myuid;
+			slot->result = result;
+			count++;
 		}
 	}
-	free(groups);
-	return 0;
+#ifndef NOT_MULTI_THREAD_SAFE
+	pthread_mutex_unlock(&mutex);
+#endif
+	return result;
 }
 
+ 
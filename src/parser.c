@@ -28,7 +28,9 @@
 #endif
 
 #include <stdlib.h>
-#include <alloca.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
 #include <ctype.h>
 
 #include "parser.h"
@@ -36,47 +38,153 @@
 #ifndef MINIMUM_DATA_SIZE
 # define MINIMUM_DATA_SIZE             128
 #endif
-#ifndef DEFAULT_MAXIMUM_DATA_SIZE
-# define DEFAULT_MAXIMUM_DATA_SIZE   32768
+#ifndef PARSER_CHUNK_SIZE
+# define PARSER_CHUNK_SIZE            4096
 #endif
 
 #ifndef _
 # define _(x) x
 #endif
 
-int parse_utf8_config( struct parsing *parsing)
+/* the classes of the chars */
+#define KEYBEG   1      /* can begin a key */
+#define KEY      2      /* can be in a key */
+#define SPACE    4      /* is a space */
+#define SPECIAL  8      /* is a quote, an escape or a $ */
+
+/* the overflows of the data */
+#define TOO_BIG    1    /* the maximum data size is reached */
+#define NO_MEMORY  2    /* the memory is depleted */
+
+/* the states where an incremental parsing resumes */
+enum label { INITIAL=0, COMMENT, KEYNAME, VALUE, ESCAPE, DOLLAR, BRACE, VARIABLE };
+
+/* append the 'length' bytes of 'data' to 'buf' */
+static int carry( struct parsebuf *buf, const char *data, size_t length)
 {
-    char c, q, acc, overflow, escape;
-    char *bdata;
-    const char *value, *head, *end, *skey, *svar, *bvar;
-    size_t lkey, lvar, ldata, datasz;
-    int  errors;
+    size_t size;
+    char *p;
+
+    if (buf->length + length > buf->size) {
+        size = buf->size ? buf->size : MINIMUM_DATA_SIZE;
+        while (size < buf->length + length)
+            size = 2 * size;
+        p = realloc( buf->buffer, size);
+        if (p == NULL)
+            return -1;
+        buf->buffer = p;
+        buf->size = size;
+    }
+    memcpy( buf->buffer + buf->length, data, length);
+    buf->length += length;
+    return 0;
+}
+
+/*
+   Enlarge the data of 'state' to hold at least 'size' bytes.
+   Return 0 in case of success or else set the overflow of 'state'
+   and return -1.
+*/
+static int enlarge( struct parsestate *state, size_t size)
+{
+    size_t datasz;
+    char *data;
+
+    if (state->maximum != 0 && size > state->maximum) {
+        state->overflow = TOO_BIG;
+        return -1;
+    }
+    datasz = state->datasz;
+    while (datasz < size)
+        datasz = 2 * datasz;
+    if (state->maximum != 0 && datasz > state->maximum)
+        datasz = state->maximum;
+    data = realloc( state->data, datasz);
+    if (data == NULL) {
+        state->overflow = NO_MEMORY;
+        return -1;
+    }
+    state->data = data;
+    state->datasz = datasz;
+    return 0;
+}
 
-#define iskeybeg(x)     (isalpha(x)||(x)=='_')
-#define iskey(x)        (isalnum(x)||(x)=='_')
+/* record in 'state' the line and column reached after 'chunk' */
+static void advance( struct parsestate *state, const char *chunk, size_t length)
+{
+    const char *head, *end, *nl;
+
+    head = chunk;
+    end = chunk + length;
+    while ((nl = memchr( head, '\n', (size_t)(end - head))) != NULL) {
+        state->lino++;
+        state->colno = 1;
+        head = nl + 1;
+    }
+    while (head != end)
+        state->colno += ((*head++ & '\xc0') != '\x80');
+    state->offset += length;
+}
+
+/*
+   Parse the 'length' bytes of 'chunk' from the state of 'parsing'.
+   When 'last' is zero, the state is recorded at end of the chunk
+   for continuing with the next chunk.
+*/
+static int parse( struct parsing *parsing, const char *chunk, size_t length, int last)
+{
+    struct parsestate *state = &parsing->state;
+    char c, q;
+    char *bdata;
+    const unsigned char *classes;
+    const char *value, *head, *end, *skey, *svar, *svalue;
+    size_t lkey, lvar, ldata, datasz, lvalue;
+
+#define iskeybeg(x)     (classes[(unsigned char)(x)] & KEYBEG)
+#define iskey(x)        (classes[(unsigned char)(x)] & KEY)
+#define isspc(x)        (classes[(unsigned char)(x)] & SPACE)
+#define isplain(x)      (!(classes[(unsigned char)(x)] & (SPACE|SPECIAL)))
+#define room(n)         (ldata + (n) <= datasz \
+                            || (enlarge( state, ldata + (n)) == 0 \
+                                && (bdata = state->data, \
+                                    datasz = state->datasz, 1)))
 #define atend           ((head-end) >= 0)
+#define suspend(x)      do{ if(!last){ state->label=(x); goto suspended; } }while(0)
 
-#define pos(x)          ((size_t)((x)-parsing->buffer))
-#define error(p,x)      do{ errors++; \
+#define pos(x)          (state->offset+(size_t)((x)-parsing->buffer))
+#define error(p,x)      do{ state->errors++; \
                             if(parsing->error \
-                                && !parsing->error(parsing,pos(p),x)) \
+                                && !parsing->error(parsing,(p),x)) \
                                 goto stop; \
                         }while(0)
 
-    /* alloc data buffer */
-    datasz = parsing->maximum_data_size;
-    if (datasz == 0)
-        datasz = DEFAULT_MAXIMUM_DATA_SIZE;
-    else if (datasz < MINIMUM_DATA_SIZE)
-        datasz = MINIMUM_DATA_SIZE;
-    bdata = alloca(datasz);
-
     /* init */
-    escape = parsing->should_escape ? 1 : 0;
-    errors = 0;
-    head = parsing->buffer;
-    end = head + parsing->length;
-    goto initial;
+    parsing->buffer = chunk;
+    parsing->length = length;
+    classes = state->classes;
+    bdata = state->data;
+    datasz = state->datasz;
+    q = state->q;
+    ldata = state->ldata;
+    head = chunk;
+    end = head + length;
+    c = 0;
+    skey = state->key.buffer;
+    lkey = state->key.length;
+    svar = head;
+    svalue = head;
+
+    /* resume */
+    switch (state->label) {
+    case COMMENT:   goto comment_resume;
+    case KEYNAME:   skey = head; goto key_resume;
+    case VALUE:     goto value;
+    case ESCAPE:    goto escape_resume;
+    case DOLLAR:    goto dollar_resume;
+    case BRACE:     goto brace_resume;
+    case VARIABLE:  goto variable_resume;
+    default:        goto initial;
+    }
 
 next_initial:
 
@@ -84,29 +192,37 @@ next_initial:
 
 initial: /* expecting key, comment or ??? */
 
-    if (atend)
+    if (atend) {
+        suspend(INITIAL);
         goto end_ok;
+    }
 
     c = *head;
 
     if (iskeybeg(c)) {
         skey = head;
+        state->skey = pos(skey);
+        state->key.length = 0;
+        state->keycarried = 0;
         goto key;
     }
 
     if (c == '#')
         goto comment;
 
-    if (!isspace(c)) 
-        error(head,_("unexpected character while looking to a key start"));
+    if (!isspc(c)) 
+        error(pos(head),_("unexpected character while looking to a key start"));
 
     goto next_initial;
 
 comment: /* skipping a comment */
 
     head++;
-    if (atend)
+comment_resume:
+    if (atend) {
+        suspend(COMMENT);
         goto end_ok;
+    }
     c = *head;
     if (c == '\n')
         goto next_initial;
@@ -115,33 +231,77 @@ comment: /* skipping a comment */
 key: /* reading a key */
 
     head++;
+key_resume:
     if (atend) {
-        error(head,_("end in a key"));
+        suspend(KEYNAME);
+        error(pos(head),_("end in a key"));
         goto stop;
     }
     c = *head;
     if (iskey(c))
         goto key;
     if (c != '=') {
-        error(head,_("unexpected character while looking to ="));
+        error(pos(head),_("unexpected character while looking to ="));
         goto next_initial;
     }
-    lkey = head - skey;
-    overflow = ldata = 0;
+    if (!state->keycarried)
+        lkey = (size_t)(head - skey);
+    else {
+        /* the key begins in a previous chunk */
+        if (carry( &state->key, skey, (size_t)(head - skey)) != 0)
+            goto out_of_memory;
+        skey = state->key.buffer;
+        lkey = state->key.length;
+    }
+    state->overflow = 0;
+    ldata = 0;
     q = 0;
-    goto next_value;
+    svalue = head + 1;
+    goto next_slice;
+
+next_slice:
+
+    head++;
+
+    /* reading a value that is a slice of the buffer */
+
+    if (atend) {
+        if (last)
+            goto end_of_slice;
+    }
+    else {
+        c = *head;
+        if (isplain(c))
+            goto next_slice;
+        if (isspc(c))
+            goto end_of_slice;
+    }
+
+    /* the value doesn't end in the chunk or it has quotes, escapes or
+       variables: its data are copied and then computed */
+    lvalue = (size_t)(head - svalue);
+    if (room(lvalue)) {
+        memcpy( bdata, svalue, lvalue);
+        ldata = lvalue;
+    }
+    goto value;
+
+end_of_slice: /* end of a value without quotes, escapes or variables */
+
+    ldata = (size_t)(head - svalue);
+    if (state->maximum != 0 && ldata > state->maximum)
+        state->overflow = TOO_BIG;
+    goto put_value;
 
 escapable:
 
-    if (escape && ldata < datasz)
+    if (parsing->should_escape && room(1))
         bdata[ldata++] = '\\';
 
 add_value: /* add the current char to data */
 
-    if (ldata < datasz)
+    if (room(1))
         bdata[ldata++] = c;
-    else
-        overflow = 1;
 
 next_value:
 
@@ -150,11 +310,13 @@ next_value:
 value: /* reading the value */
 
     if (atend) {
+        suspend(VALUE);
+
         /* end in the value */
         if (!q)
             goto end_of_value;
 
-        error(head,_("end in quoted value"));
+        error(pos(head),_("end in quoted value"));
         goto stop;
     }
 
@@ -165,8 +327,10 @@ value: /* reading the value */
         if (q == '\'')
             goto escapable;
         ++head;
+escape_resume:
         if (atend) {
-            error(head,_("end after escape char"));
+            suspend(ESCAPE);
+            error(pos(head),_("end after escape char"));
             goto stop;
         }
         c = *head;
@@ -189,30 +353,36 @@ value: /* reading the value */
             goto escapable;
 
         /* begin of a variable, just after $ */
-        bvar = head++;
+        state->bvar = pos(head++);
+dollar_resume:
         if (atend) {
-            error(head,_("end after $"));
+            suspend(DOLLAR);
+            error(pos(head),_("end after $"));
             goto stop;
         }
         c = *head;
-        acc = c;
+        state->acc = c;
         if (c == '{') {
             ++head;
+brace_resume:
             if (atend) {
-                error(head,_("end after ${"));
+                suspend(BRACE);
+                error(pos(head),_("end after ${"));
                 goto stop;
             }
             c = *head;
         }
         if (!iskeybeg(c)) {
-            error(head,_("invalid character after $ or ${"));
+            error(pos(head),_("invalid character after $ or ${"));
             goto value;
         }
         svar = head;
+        state->var.length = 0;
+        state->varcarried = 0;
         goto variable;
 
     default:
-        if (q || !isspace(c)) 
+        if (q || !isspc(c)) 
             goto add_value;
 
         goto end_of_value;
@@ -220,10 +390,16 @@ value: /* reading the value */
 
 end_of_value: /* end of the value */
 
-    if (overflow)
-        error(head,_("value too big"));
+    svalue = bdata;
+
+put_value:
+
+    if (state->overflow == NO_MEMORY)
+        error(pos(head),_("out of memory"));
+    else if (state->overflow)
+        error(pos(head),_("value too big"));
     else if (parsing->put)
-        parsing->put( parsing, skey, lkey, bdata, ldata, pos(skey), pos(head));
+        parsing->put( parsing, skey, lkey, svalue, ldata, state->skey, pos(head));
     if (atend)
         goto initial;
     goto next_initial;
@@ -231,51 +407,187 @@ end_of_value: /* end of the value */
 variable: /* read a variable */
 
     ++head;
+variable_resume:
     if (atend) {
-        if (acc == '{')
-            error(head,_("unmatched pair { }"));
-        lvar = head - svar;
+        suspend(VARIABLE);
+        if (state->acc == '{')
+            error(pos(head),_("unmatched pair { }"));
     }
     else {
         c = *head;
         if (iskey(c))
             goto variable;
-        lvar = head - svar;
-        if (acc == '{') {
-            if (c == '}')
-                ++head;
-            else
-                error(head,_("unmatched pair { }"));
-        }
+    }
+    if (!state->varcarried)
+        lvar = (size_t)(head - svar);
+    else {
+        /* the variable begins in a previous chunk */
+        if (carry( &state->var, svar, (size_t)(head - svar)) != 0)
+            goto out_of_memory;
+        svar = state->var.buffer;
+        lvar = state->var.length;
+    }
+    if (!atend && state->acc == '{') {
+        if (c == '}')
+            ++head;
+        else
+            error(pos(head),_("unmatched pair { }"));
     }
     if (parsing->get) {
-        value = parsing->get( parsing, svar,lvar,pos(bvar),pos(head));
+        value = parsing->get( parsing, svar,lvar,state->bvar,pos(head));
         if (value == NULL)
-            error(bvar,_("no value for the variable"));
+            error(state->bvar,_("no value for the variable"));
         else {
-            while (*value) {
-                if (ldata < datasz)
-                    bdata[ldata++] = *value++;
-                else {
-                    overflow = 1;
-                    break;
-                }
+            lvalue = strlen( value);
+            if (room(lvalue)) {
+                memcpy( bdata + ldata, value, lvalue);
+                ldata += lvalue;
             }
         }
     }
     goto value;
 
+suspended: /* end of the chunk, record the state */
+
+    switch (state->label) {
+    case KEYNAME:
+        if (carry( &state->key, skey, (size_t)(end - skey)) != 0)
+            goto out_of_memory;
+        state->keycarried = 1;
+        break;
+    case VARIABLE:
+        if (carry( &state->var, svar, (size_t)(end - svar)) != 0)
+            goto out_of_memory;
+        state->varcarried = 1;
+        /* fall through */
+    case VALUE:
+    case ESCAPE:
+    case DOLLAR:
+    case BRACE:
+        if (!state->keycarried) {
+            if (carry( &state->key, skey, lkey) != 0)
+                goto out_of_memory;
+            state->keycarried = 1;
+        }
+        break;
+    }
+    state->q = q;
+    state->ldata = ldata;
+    advance( state, parsing->buffer, parsing->length);
+    return 0;
+
+out_of_memory:
+    error(pos(head),_("out of memory"));
 stop:
+    state->stopped = 1;
 end_ok:
-    return -errors;
+    return -state->errors;
     
 #undef error
+#undef room
+#undef isplain
 #undef pos
+#undef suspend
 #undef atend
+#undef isspc
 #undef iskey
 #undef iskeybeg
 }
 
+int parse_utf8_begin( struct parsing *parsing)
+{
+    struct parsestate *state = &parsing->state;
+    size_t maximum;
+    int i;
+    char c;
+
+    /* alloc data buffer, it grows up to the maximum if any */
+    maximum = parsing->maximum_data_size;
+    if (maximum != 0 && maximum < MINIMUM_DATA_SIZE)
+        maximum = MINIMUM_DATA_SIZE;
+    memset( state, 0, sizeof * state);
+    state->data = malloc( MINIMUM_DATA_SIZE);
+    if (state->data == NULL)
+        return -1;
+
+    /* init */
+    state->maximum = maximum;
+    state->datasz = MINIMUM_DATA_SIZE;
+    state->label = INITIAL;
+    state->lino = 1;
+    state->colno = 1;
+
+    /* the classes of the chars, as given by the current locale */
+    for (i = 0 ; i < 256 ; i++) {
+        c = (char)i;
+        state->classes[i] = (unsigned char)(
+                              (isalpha(c) || c == '_' ? KEYBEG : 0)
+                            | (isalnum(c) || c == '_' ? KEY : 0)
+                            | (isspace(c) ? SPACE : 0)
+                            | (c == '\\' || c == '\'' || c == '"' || c == '$'
+                                                        ? SPECIAL : 0));
+    }
+    return 0;
+}
+
+int parse_utf8_feed( struct parsing *parsing, const char *chunk, size_t length)
+{
+    if (!parsing->state.stopped)
+        parse( parsing, chunk, length, 0);
+    return parsing->state.stopped ? -1 : 0;
+}
+
+int parse_utf8_finish( struct parsing *parsing)
+{
+    struct parsestate *state = &parsing->state;
+
+    if (!state->stopped)
+        parse( parsing, "", 0, 1);
+    free( state->data);
+    free( state->key.buffer);
+    free( state->var.buffer);
+    state->data = NULL;
+    state->key.buffer = NULL;
+    state->var.buffer = NULL;
+    return -state->errors;
+}
+
+int parse_utf8_config( struct parsing *parsing)
+{
+    if (parse_utf8_begin( parsing) != 0)
+        return -1;
+    parse( parsing, parsing->buffer, parsing->length, 1);
+    parsing->state.stopped = 1;
+    return parse_utf8_finish( parsing);
+}
+
+int parse_utf8_config_fd( struct parsing *parsing, int fd)
+{
+    char chunk[PARSER_CHUNK_SIZE];
+    ssize_t status;
+
+    if (parse_utf8_begin( parsing) != 0)
+        return -1;
+
+    for (;;) {
+        status = read( fd, chunk, sizeof chunk);
+        if (status > 0) {
+            if (parse_utf8_feed( parsing, chunk, (size_t)status) != 0)
+                break;
+        }
+        else if (status == 0)
+            break;
+        else if (errno != EAGAIN && errno != EINTR) {
+            parsing->state.errors++;
+            parsing->state.stopped = 1;
+            if (parsing->error)
+                parsing->error( parsing, parsing->state.offset, _("read error"));
+            break;
+        }
+    }
+    return parse_utf8_finish( parsing);
+}
+
 void parse_utf8_info(
             struct parsing *parsing,
             struct parsinfo *info,
@@ -287,9 +599,10 @@ void parse_utf8_info(
     int lino, colno;
 
     /* init */
-    lino = 1, colno = 1;
+    lino = parsing->state.lino, colno = parsing->state.colno;
     buf = begin = end = parsing->buffer;
     length = parsing->length;
+    pos = pos < parsing->state.offset ? 0 : pos - parsing->state.offset;
     if (length < pos)
         pos = length;
 
@@ -317,3 +630,133 @@ void parse_utf8_info(
     info->colno = colno;
 }
 
+
+#ifdef TEST_PARSER
+#include <stdio.h>
+
+/* the events of the parsing, recorded by the callbacks */
+static FILE *events;
+
+/* the maximum data size of the parsings */
+static size_t maximum;
+
+static const char *test_get( struct parsing *parsing,
+                const char *key, size_t length,
+                size_t begin_pos, size_t end_pos)
+{
+    fprintf( events, "get %.*s %zu %zu\n", (int)length, key, begin_pos, end_pos);
+    return length == 3 && !memcmp( key, "BAD", 3) ? NULL : "(v)";
+}
+
+static int test_put( struct parsing *parsing,
+                const char *key, size_t key_length,
+                const char *value, size_t value_length,
+                size_t begin_pos, size_t end_pos)
+{
+    fprintf( events, "put %.*s=%.*s %zu %zu\n", (int)key_length, key,
+                (int)value_length, value, begin_pos, end_pos);
+    return 0;
+}
+
+static int test_error( struct parsing *parsing,
+                size_t position, const char *message)
+{
+    struct parsinfo info;
+
+    parse_utf8_info( parsing, &info, position);
+    fprintf( events, "error %zu %d %s\n", position, info.lino, message);
+    return 1;
+}
+
+/* parse 'data' by chunks of 'size' bytes or at once if 'size' is 0 */
+static char *test_parse( const char *data, size_t length, size_t size)
+{
+    struct parsing parsing;
+    char *result;
+    size_t count, offset;
+    int status;
+
+    events = open_memstream( &result, &count);
+    parsing.buffer = data;
+    parsing.length = length;
+    parsing.maximum_data_size = maximum;
+    parsing.should_escape = 1;
+    parsing.data = NULL;
+    parsing.get = test_get;
+    parsing.put = test_put;
+    parsing.error = test_error;
+    if (size == 0)
+        status = parse_utf8_config( &parsing);
+    else {
+        parse_utf8_begin( &parsing);
+        for (offset = 0 ; offset < length ; offset += size)
+            parse_utf8_feed( &parsing, data + offset,
+                    length - offset < size ? length - offset : size);
+        status = parse_utf8_finish( &parsing);
+    }
+    fprintf( events, "status %d\n", status);
+    fclose( events);
+    return result;
+}
+
+int main( int argc, char **argv)
+{
+    static const char *samples[] = {
+        "A=1\nB=$A\n# comment\nC=\"x y\"'$A'\\ z${B}/p\n",
+        "KEY_LONG_NAME=${KEY_LONG_NAME_TOO} D=a\\\"b ${BAD} E=$%\n",
+        "F=\"unterminated\n",
+        "G=${H",
+        "I=$",
+        "J=${",
+        "K\\=1 L",
+        "M=\\",
+        NULL
+    };
+    static const size_t sizes[] = { 1, 7, 4096, 0 };
+    char *whole, *chunked, *big;
+    size_t length, size;
+    int i, j, errors = 0;
+
+    for (i = 0 ; samples[i] != NULL ; i++) {
+        length = strlen( samples[i]);
+        whole = test_parse( samples[i], length, 0);
+        for (size = 1 ; size <= length ; size++) {
+            chunked = test_parse( samples[i], length, size);
+            if (strcmp( whole, chunked)) {
+                printf( "sample %d chunk %zu\n%s--- differs from\n%s", i, size, chunked, whole);
+                errors++;
+            }
+            free( chunked);
+        }
+        free( whole);
+    }
+
+    /* values bigger than 32 KiB, plain and quoted, then with a maximum */
+    length = 100000;
+    big = malloc( length + 1);
+    memset( big, 'v', length);
+    memcpy( big, "N=", 2);
+    memcpy( big + length / 2, "\nO=\"", 4);
+    memcpy( big + length - 2, "\"\n", 3);
+    for (maximum = 0 ; maximum <= MINIMUM_DATA_SIZE ; maximum += MINIMUM_DATA_SIZE) {
+        whole = test_parse( big, length, 0);
+        if ((strstr( whole, "error") == NULL) != (maximum == 0)) {
+            printf( "big with maximum %zu\n%.200s\n", maximum, whole);
+            errors++;
+        }
+        for (j = 0 ; sizes[j] != 0 ; j++) {
+            chunked = test_parse( big, length, sizes[j]);
+            if (strcmp( whole, chunked)) {
+                printf( "big with maximum %zu chunk %zu differs\n", maximum, sizes[j]);
+                errors++;
+            }
+            free( chunked);
+        }
+        free( whole);
+    }
+    free( big);
+
+    printf( "%d errors\n", errors);
+    return errors != 0;
+}
+#endif
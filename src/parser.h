@@ -24,16 +24,53 @@
 #ifndef TIZEN_PLATFORM_WRAPPER_PARSER_H
 #define TIZEN_PLATFORM_WRAPPER_PARSER_H
 
+/* growable buffer of the parser */
+struct parsebuf {
+    char  *buffer;      /* the data */
+    size_t length;      /* length of the data */
+    size_t size;        /* allocated size */
+};
+
+/*
+ State of the parsing, recorded between the chunks of an
+ incremental parsing. It is private to the parser.
+*/
+struct parsestate {
+    int     label;      /* where to resume the parsing */
+    int     errors;     /* count of errors */
+    int     stopped;    /* is the parsing stopped? */
+    char    q;          /* the current quote */
+    char    acc;        /* the char after $ */
+    char    overflow;   /* is the value lost (too big or no memory)? */
+    char    keycarried; /* is the key recorded in 'key'? */
+    char    varcarried; /* is the variable recorded in 'var'? */
+    size_t  offset;     /* offset of the current chunk */
+    int     lino;       /* line number at begin of the current chunk */
+    int     colno;      /* column number at begin of the current chunk */
+    size_t  skey;       /* position of the current key */
+    size_t  bvar;       /* position of the current $ */
+    size_t  ldata;      /* length of the data of the current value */
+    size_t  maximum;    /* maximum size of 'data' or 0 */
+    size_t  datasz;     /* size of 'data' */
+    char   *data;       /* data of the current value */
+    struct parsebuf key;  /* current key when it spans chunks */
+    struct parsebuf var;  /* current variable when it spans chunks */
+    unsigned char classes[256]; /* classes of the chars */
+};
+
 /* structure used for parsing config files */
 struct parsing {
 
-    /* The buffer to parse. */
+    /*
+      The buffer to parse. When parsing incrementally, it is
+      the chunk currently parsed.
+    */
     const char *buffer; 
 
     /* The length of the buffer to parse. */
     size_t length; 
 
-    /* The maximum data size allowed */
+    /* The maximum data size allowed for a value, 0 for no limit */
     size_t maximum_data_size;
 
     /* Some user data, please use it as you wish. */
@@ -56,6 +93,8 @@ struct parsing {
       Should add/insert/replace the key/value pair
       given. This values aren't zero terminated.
       The given length is the one without terminating nul.
+      The value can point in the parsed buffer or in
+      the parser's data: it is only valid during the call.
     */
     int (*put)( struct parsing *parsing, 
                 const char *key, size_t key_length, 
@@ -66,11 +105,16 @@ struct parsing {
       Callback function to report errors.
       'buffer' is the scanned buffer.
       'position' is the position of the character raising the error.
+      The positions given to the callbacks are offsets from the
+      begin of the parsed input, even when parsing incrementally.
       'message' is a short explanation of the error.
       Should return 0 to stop parsing;
     */
     int (*error)( struct parsing *parsing, 
                 size_t position, const char *message);
+
+    /* Private state of the parser. */
+    struct parsestate state;
 };
 
 /*
@@ -84,6 +128,48 @@ int parse_utf8_config(
     struct parsing *parsing
 );
 
+/*
+   Begin to parse incrementally the config file using data of 'parsing'.
+   The input is then given chunk by chunk to parse_utf8_feed and
+   the parsing ends by calling parse_utf8_finish.
+   Return 0 in case of success or -1 on memory depletion.
+*/
+int parse_utf8_begin(
+    struct parsing *parsing
+);
+
+/*
+   Parse the 'length' bytes of 'chunk' that follow the previously fed
+   chunks. The callbacks only receive pointers valid during their call.
+   Return 0 if the parsing can continue or -1 if it was stopped.
+*/
+int parse_utf8_feed(
+    struct parsing *parsing,
+    const char *chunk,
+    size_t length
+);
+
+/*
+   End the incremental parsing and release its resources.
+   Return 0 if not error found or a negative number
+   corresponding to the opposite of the count of found errors.
+*/
+int parse_utf8_finish(
+    struct parsing *parsing
+);
+
+/*
+   Parse the config file read from the file descriptor 'fd' until its end,
+   chunk by chunk, using data of 'parsing'. The memory used doesn't depend
+   on the size of the file.
+   Return 0 if not error found or a negative number
+   corresponding to the opposite of the count of found errors.
+*/
+int parse_utf8_config_fd(
+    struct parsing *parsing,
+    int fd
+);
+
 /* Structure for getting information about a position. */
 struct parsinfo {
     const char *begin; /* pointer to the first char of the line */
@@ -99,6 +185,9 @@ struct parsinfo {
   This function computes into info the pointers of the line containig the
   char of offset 'pos', the number of this line and the column number of
   the position within the line.
+  When parsing incrementally, only the current chunk is available: the
+  line is cut at the begin of the chunk and the positions before the
+  chunk are reported at its begin.
   Note: works on utf8 data.
 */
 void parse_utf8_info(
@@ -37,54 +37,99 @@
 
 #ifndef NOT_PASSWD_ONLY
 
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/stat.h>
+#include <time.h>
+#ifndef NOT_MULTI_THREAD_SAFE
+#include <pthread.h>
+#endif
+
 #include "buffer.h"
+#include "atomic.h"
+
+#ifndef PASSWD_FILE
+#define PASSWD_FILE  "/etc/passwd"
+#endif
+
+#ifndef PASSWD_CHECK_DELAY
+#define PASSWD_CHECK_DELAY  1  /* seconds between checks by pw_generation */
+#endif
 
 /* index of fields */
 enum { iname, ipasswd, iuid, igid, icmt, idir, ishell };
 
-static const char pwfile[] = "/etc/passwd";
-static struct buffer buffer;
-static size_t pos, lengths[7];
-static const char *starts[7];
+static const char pwfile[] = PASSWD_FILE;
 
-#define is(s,i) (!strncmp(s,starts[i],lengths[i]) && !s[lengths[i]])
+/* cursor for reading the passwd file */
+struct pwcursor {
+    struct buffer buffer;       /* content of the file */
+    size_t pos;                 /* position of the next entry */
+    size_t lengths[7];          /* lengths of the fields of the entry */
+    const char *starts[7];      /* starts of the fields of the entry */
+};
 
 /* open the passwd file */
-static int oppw()
+static int oppw( struct pwcursor *cursor)
 {
-    pos = 0;
-    return buffer_create( &buffer, pwfile);
+    cursor->pos = 0;
+    return buffer_create( &cursor->buffer, pwfile);
 }
 
 /* close the passwd file */
-static void clpw()
+static void clpw( struct pwcursor *cursor)
+{
+    buffer_destroy( &cursor->buffer);
+}
+
+/* return the first ':' or '\n' from 'head' to 'end' or 'end' if none */
+static inline const char *pwdelim( const char *head, const char *end)
 {
-    buffer_destroy( &buffer);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    /* search 8 bytes at a time: a byte of 'x' or 'y' is zero at the
+       position of a delimiter, the lowest bit set in 'found' is exact */
+    uint64_t word, x, y, found;
+
+    while (end - head >= (ptrdiff_t)sizeof word) {
+        memcpy( &word, head, sizeof word);
+        x = word ^ 0x3a3a3a3a3a3a3a3aULL;
+        y = word ^ 0x0a0a0a0a0a0a0a0aULL;
+        found = (((x - 0x0101010101010101ULL) & ~x)
+                    | ((y - 0x0101010101010101ULL) & ~y))
+                & 0x8080808080808080ULL;
+        if (found)
+            return head + (__builtin_ctzll( found) >> 3);
+        head += sizeof word;
+    }
+#endif
+    while (head != end && *head != ':' && *head != '\n')
+        head++;
+    return head;
 }
 
 /* read the passwd file */
-static int rdpw()
+static int rdpw( struct pwcursor *cursor)
 {
     int col = 0;
-    const char *head = buffer.buffer + pos;
-    const char *end = buffer.buffer + buffer.length;
+    const char *head = cursor->buffer.buffer + cursor->pos;
+    const char *end = cursor->buffer.buffer + cursor->buffer.length;
     while (head != end) {
-        starts[col] = head;
-        while(head!=end && *head!=':' && *head!='\n') head++;
-        lengths[col] = head - starts[col];
+        cursor->starts[col] = head;
+        head = pwdelim( head, end);
+        cursor->lengths[col] = head - cursor->starts[col];
         col++;
         if (col == 7) {
             if (head==end) {
-                pos = head - buffer.buffer;
+                cursor->pos = head - cursor->buffer.buffer;
                 return 1;
             }
             if (*head=='\n') {
                 head++;
-                pos = head - buffer.buffer;
+                cursor->pos = head - cursor->buffer.buffer;
                 return 1;
             }
-            while (head!=end && *head!='\n') head++;
-            if (head!=end) head++;
+            head = memchr( head, '\n', end - head);
+            head = head == NULL ? end : head + 1;
             col = 0;
         }
         else {
@@ -94,166 +139,639 @@ static int rdpw()
             }
         }
     }
-    pos = head - buffer.buffer;
+    cursor->pos = head - cursor->buffer.buffer;
+    return 0;
+}
+
+/* value of the numeric field 'i' of the entry of 'cursor' */
+static unsigned pwnum( struct pwcursor *cursor, int i)
+{
+    const char *field = cursor->starts[i];
+    size_t length = cursor->lengths[i];
+    unsigned result = 0;
+
+    /* up to 9 digits can't overflow, other cases are left to atoi */
+    if (length == 0 || length > 9)
+        return (unsigned)atoi(field);
+    while (length--) {
+        if (*field < '0' || *field > '9')
+            return (unsigned)atoi(cursor->starts[i]);
+        result = 10 * result + (unsigned)(*field++ - '0');
+    }
+    return result;
+}
+
+/* hash code of the 'uid' */
+static inline size_t hashuid( uid_t uid)
+{
+    return (size_t)uid * 2654435761u;
+}
+
+/* hash code of the 'name' */
+static inline size_t hashname( const char *name)
+{
+    size_t result = 2166136261u;
+    while (*name)
+        result = (result ^ (unsigned char)*name++) * 16777619u;
+    return result;
+}
+
+/* entry of the index of the passwd file */
+struct pwentry {
+    uid_t uid;          /* value of the uid */
+    gid_t gid;          /* value of the gid */
+    int hasuid;         /* is the field of the uid not empty? */
+    size_t name;        /* offset of the name in the pool */
+    size_t id;          /* offset of the uid field in the pool */
+    size_t dir;         /* offset of the home directory in the pool */
+};
+
+/* index of the passwd file */
+struct pwindex {
+    int refcount;               /* count of references */
+    unsigned long generation;   /* count of the built indexes */
+    dev_t dev;                  /* device of the indexed file */
+    ino_t ino;                  /* inode of the indexed file */
+    off_t size;                 /* size of the indexed file */
+    struct timespec mtime;      /* modification time of the indexed file */
+    char *pool;                 /* the copied fields, null terminated */
+    struct pwentry *entries;    /* the entries in the order of the file */
+    size_t count;               /* count of entries */
+    size_t mask;                /* mask of the tables (capacity - 1) */
+    unsigned *byuid;            /* entries by uid, index + 1, 0 if free */
+    unsigned *byname;           /* entries by name, index + 1, 0 if free */
+};
+
+/* the index of the current passwd file */
+static struct pwindex *pwcurrent = NULL;
+static unsigned long pwgeneration = 0;
+static time_t pwnextcheck = 0;  /* time of the next check of pw_generation */
+#ifndef NOT_MULTI_THREAD_SAFE
+static pthread_mutex_t pwmutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/* free the memory of the 'index' */
+static void pwindex_free( struct pwindex *index)
+{
+    free( index->pool);
+    free( index->entries);
+    free( index->byuid);
+    free( index->byname);
+}
+
+/* add the entry 'n' of hash code 'hash' in the table 'table' of 'mask' */
+static void pwindex_put( unsigned *table, size_t mask, size_t hash, unsigned n)
+{
+    hash &= mask;
+    while (table[hash])
+        hash = (hash + 1) & mask;
+    table[hash] = n + 1;
+}
+
+/* copy in 'pool' at 'offset' the field 'i' of the entry of 'cursor' */
+static size_t pwindex_copy( char *pool, size_t *offset,
+                                        struct pwcursor *cursor, int i)
+{
+    size_t result = *offset;
+    memcpy( pool + result, cursor->starts[i], cursor->lengths[i]);
+    pool[result + cursor->lengths[i]] = 0;
+    *offset = result + cursor->lengths[i] + 1;
+    return result;
+}
+
+/* build the 'index' of the passwd file */
+static int pwindex_build( struct pwindex *index)
+{
+    struct pwcursor cursor;
+    struct pwentry *entries, *entry;
+    size_t offset, capacity, n;
+
+    if (oppw( &cursor) != 0)
+        return -1;
+
+    /* at least 3 separators per entry, enough for 3 copied fields */
+    index->pool = malloc( cursor.buffer.length + 1);
+    index->entries = NULL;
+    index->byuid = index->byname = NULL;
+    index->count = 0;
+    capacity = 0;
+    offset = 0;
+    if (index->pool == NULL)
+        goto error;
+
+    /* read the entries */
+    while (rdpw( &cursor)) {
+        if (index->count == capacity) {
+            capacity = capacity ? 2 * capacity : 64;
+            entries = realloc( index->entries, capacity * sizeof * entries);
+            if (entries == NULL)
+                goto error;
+            index->entries = entries;
+        }
+        entry = &index->entries[index->count++];
+        entry->hasuid = cursor.lengths[iuid] != 0;
+        entry->uid = (uid_t)pwnum( &cursor, iuid);
+        entry->gid = (gid_t)pwnum( &cursor, igid);
+        entry->name = pwindex_copy( index->pool, &offset, &cursor, iname);
+        entry->id = pwindex_copy( index->pool, &offset, &cursor, iuid);
+        entry->dir = pwindex_copy( index->pool, &offset, &cursor, idir);
+    }
+    clpw( &cursor);
+
+    /* build the tables with a load factor under 1/2 */
+    capacity = 16;
+    while (capacity < 2 * index->count)
+        capacity = 2 * capacity;
+    index->mask = capacity - 1;
+    index->byuid = calloc( capacity, sizeof * index->byuid);
+    index->byname = calloc( capacity, sizeof * index->byname);
+    if (index->byuid == NULL || index->byname == NULL) {
+        pwindex_free( index);
+        return -1;
+    }
+    for (n = 0 ; n < index->count ; n++) {
+        entry = &index->entries[n];
+        pwindex_put( index->byuid, index->mask,
+                                            hashuid( entry->uid), (unsigned)n);
+        pwindex_put( index->byname, index->mask,
+                            hashname( index->pool + entry->name), (unsigned)n);
+    }
     return 0;
+
+error:
+    clpw( &cursor);
+    pwindex_free( index);
+    errno = ENOMEM;
+    return -1;
+}
+
+/* release a reference to the 'index' */
+static void pwrelease( struct pwindex *index)
+{
+    if (!_ATOMIC_DEC_( &index->refcount)) {
+        pwindex_free( index);
+        free( index);
+    }
+}
+
+/*
+   Return the index of the passwd file, with a new reference, after
+   checking that it is up to date. Return NULL on error.
+   The lookups in the returned index need no lock. The index must be
+   released using pwrelease.
+*/
+static struct pwindex *pwacquire()
+{
+    struct stat st;
+    struct pwindex *index, *old;
+
+    if (stat( pwfile, &st) != 0)
+        return NULL;
+
+#ifndef NOT_MULTI_THREAD_SAFE
+    pthread_mutex_lock( &pwmutex);
+#endif
+    index = pwcurrent;
+    if (index == NULL
+            || index->dev != st.st_dev
+            || index->ino != st.st_ino
+            || index->size != st.st_size
+            || index->mtime.tv_sec != st.st_mtim.tv_sec
+            || index->mtime.tv_nsec != st.st_mtim.tv_nsec) {
+        index = malloc( sizeof * index);
+        if (index == NULL)
+            errno = ENOMEM;
+        else if (pwindex_build( index) != 0) {
+            free( index);
+            index = NULL;
+        }
+        else {
+            index->refcount = 1;
+            index->generation = _ATOMIC_INC_( &pwgeneration);
+            index->dev = st.st_dev;
+            index->ino = st.st_ino;
+            index->size = st.st_size;
+            index->mtime = st.st_mtim;
+            old = pwcurrent;
+            pwcurrent = index;
+            if (old != NULL)
+                pwrelease( old);
+        }
+    }
+    if (index != NULL)
+        _ATOMIC_INC_( &index->refcount);
+#ifndef NOT_MULTI_THREAD_SAFE
+    pthread_mutex_unlock( &pwmutex);
+#endif
+    return index;
+}
+
+/* return the first entry of the 'index' for 'uid' whose uid field
+is 'id' or, if 'id' is NULL, whose uid field isn't empty */
+static struct pwentry *pwbyuid( struct pwindex *index, uid_t uid,
+                                                            const char *id)
+{
+    struct pwentry *entry;
+    size_t hash;
+    unsigned n;
+
+    hash = hashuid( uid) & index->mask;
+    while ((n = index->byuid[hash]) != 0) {
+        entry = &index->entries[n - 1];
+        if (entry->uid == uid
+                && (id == NULL ? entry->hasuid
+                            : !strcmp( id, index->pool + entry->id)))
+            return entry;
+        hash = (hash + 1) & index->mask;
+    }
+    return NULL;
+}
+
+/* return the first entry of the 'index' for 'name' */
+static struct pwentry *pwbyname( struct pwindex *index, const char *name)
+{
+    struct pwentry *entry;
+    size_t hash;
+    unsigned n;
+
+    hash = hashname( name) & index->mask;
+    while ((n = index->byname[hash]) != 0) {
+        entry = &index->entries[n - 1];
+        if (!strcmp( name, index->pool + entry->name))
+            return entry;
+        hash = (hash + 1) & index->mask;
+    }
+    return NULL;
 }
 
 int pw_get( struct heap *heap, struct pwget **items)
 {
-    size_t user, home;
-    int result;
-    int i, n, s;
+    struct pwindex *index;
+    struct pwentry *entry;
+    int n;
 
     for( n = 0 ; items[n] != NULL ; n++ )
         items[n]->set = 0;
 
-    result = oppw();
-    if (result == 0) {
-        s = n;
-        while (s && rdpw()) {
-            user = home = HNULL;
-            for( i = 0 ; i < n ; i++ ) {
-                if (!items[i]->set && is(items[i]->id,iuid)) {
-                    if (user==HNULL) {
-                        user = heap_strndup( heap,
-                                            starts[iname], lengths[iname]);
-                        home = heap_strndup( heap,
-                                            starts[idir], lengths[idir]);
-                    }
-                    items[i]->set = 1;
-                    items[i]->user = user;
-                    items[i]->home = home;
-                    s--;
-                }
-            }
+    index = pwacquire();
+    if (index == NULL)
+        return -1;
+
+    for( n = 0 ; items[n] != NULL ; n++ ) {
+        entry = pwbyuid( index, (uid_t)atoi(items[n]->id), items[n]->id);
+        if (entry != NULL) {
+            items[n]->set = 1;
+            items[n]->user = heap_strdup( heap, index->pool + entry->name);
+            items[n]->home = heap_strdup( heap, index->pool + entry->dir);
         }
-        clpw();
     }
-    return result;
+    pwrelease( index);
+    return 0;
 }
 
 int pw_has_uid( uid_t uid)
 {
-    if (oppw() == 0) {
-        while (rdpw()) {
-            if (lengths[iuid] && (int)uid == atoi(starts[iuid])) {
-                clpw();
-                return 1;
-            }
-        }
-        clpw();
+    struct pwindex *index;
+    int result = 0;
+
+    index = pwacquire();
+    if (index != NULL) {
+        result = pwbyuid( index, uid, NULL) != NULL;
+        pwrelease( index);
     }
-    return 0;
+    return result;
+}
+
+/* current time in seconds, not affected by changes of the clock */
+static time_t pw_now()
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec;
+}
+
+unsigned long pw_generation()
+{
+    struct pwindex *index;
+    unsigned long result = 0;
+    time_t now;
+
+    /* the file is checked at most once per PASSWD_CHECK_DELAY, in between
+       the generation is the one of the last index built, that is also
+       updated by the other functions checking the file */
+    now = pw_now();
+    if (now < _RELAXED_GET_( &pwnextcheck))
+        return _ATOMIC_GET_( &pwgeneration);
+
+    index = pwacquire();
+    if (index != NULL) {
+        result = index->generation;
+        pwrelease( index);
+        _RELAXED_SET_( &pwnextcheck, now + PASSWD_CHECK_DELAY);
+    }
+    return result;
 }
 
 int pw_get_uid( const char *name, uid_t *uid)
 {
-    int result = oppw();
-    if (result == 0) {
-        while (rdpw()) {
-            if (is(name,iname)) {
-                *uid = (uid_t)atoi(starts[iuid]);
-                clpw();
-                return 0;
-            }
-        }
-        clpw();
-        result = -1;
+    struct pwindex *index;
+    struct pwentry *entry;
+
+    index = pwacquire();
+    if (index == NULL)
+        return -1;
+
+    entry = pwbyname( index, name);
+    if (entry != NULL)
+        *uid = entry->uid;
+    pwrelease( index);
+    if (entry == NULL) {
         errno = EEXIST;
+        return -1;
     }
-    return result;
+    return 0;
 }
 
 int pw_get_gid( const char *name, gid_t *gid)
 {
-    int result = oppw();
-    if (result == 0) {
-        while (rdpw()) {
-            if (is(name,iname)) {
-                *gid = (gid_t)atoi(starts[igid]);
-                clpw();
-                return 0;
-            }
-        }
-        clpw();
-        result = -1;
+    struct pwindex *index;
+    struct pwentry *entry;
+
+    index = pwacquire();
+    if (index == NULL)
+        return -1;
+
+    entry = pwbyname( index, name);
+    if (entry != NULL)
+        *gid = entry->gid;
+    pwrelease( index);
+    if (entry == NULL) {
         errno = EEXIST;
+        return -1;
     }
-    return result;
+    return 0;
 }
 
 #else
 
 #include <pwd.h>
+#include <time.h>
+#ifndef NOT_MULTI_THREAD_SAFE
+#include <pthread.h>
+#endif
 
 #define BUFSIZE  4096
 
+#ifndef NSS_CACHE_COUNT
+#define NSS_CACHE_COUNT  32    /* count of entries of the cache */
+#endif
+
+#ifndef NSS_CACHE_TTL
+#define NSS_CACHE_TTL    30    /* validity of the entries in seconds */
+#endif
+
+#if NSS_CACHE_COUNT <= 0
+#error "bad value for NSS_CACHE_COUNT"
+#endif
+
+/* entry of the cache of the users */
+struct nssentry {
+    time_t expire;      /* time of expiration of the entry */
+    uid_t uid;          /* uid of the user */
+    gid_t gid;          /* gid of the user */
+    char *name;         /* name of the user */
+    char *dir;          /* home directory, allocated with name */
+};
+
+/* the cached users, the most recently used first */
+static struct nssentry nsscache[NSS_CACHE_COUNT];
+static int nsscount = 0;
+#ifndef NOT_MULTI_THREAD_SAFE
+static pthread_mutex_t nssmutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/* current time in seconds, not affected by changes of the clock */
+static time_t nss_now()
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec;
+}
+
+static inline void nss_lock()
+{
+#ifndef NOT_MULTI_THREAD_SAFE
+    pthread_mutex_lock( &nssmutex);
+#endif
+}
+
+static inline void nss_unlock()
+{
+#ifndef NOT_MULTI_THREAD_SAFE
+    pthread_mutex_unlock( &nssmutex);
+#endif
+}
+
+/* search the user of 'name' if not NULL or else of 'uid'
+and put it at first position. The lock must be held. */
+static struct nssentry *nss_search( uid_t uid, const char *name)
+{
+    struct nssentry entry;
+    time_t now;
+    int i;
+
+    now = nss_now();
+    i = 0;
+    while (i < nsscount) {
+        if (nsscache[i].expire <= now) {
+            /* remove the expired entry */
+            free( nsscache[i].name);
+            nsscount--;
+            memmove( &nsscache[i], &nsscache[i + 1],
+                                (nsscount - i) * sizeof * nsscache);
+        }
+        else if (name == NULL ? nsscache[i].uid == uid
+                                : !strcmp( name, nsscache[i].name)) {
+            entry = nsscache[i];
+            memmove( &nsscache[1], &nsscache[0], i * sizeof * nsscache);
+            nsscache[0] = entry;
+            return &nsscache[0];
+        }
+        else
+            i++;
+    }
+    return NULL;
+}
+
+/* get from NSS the user of 'name' if not NULL or else of 'uid'.
+Return 0 if found, -1 if not found or else an error code. */
+static int nss_fetch( uid_t uid, const char *name, struct nssentry *entry)
+{
+    char stack[BUFSIZE], *buffer, *p;
+    struct passwd pwd, *pe;
+    size_t size, lname, ldir;
+    int result;
+
+    /* get the entry, growing the buffer as needed */
+    buffer = stack;
+    size = sizeof stack;
+    for (;;) {
+        result = name != NULL
+                    ? getpwnam_r( name, &pwd, buffer, size, &pe)
+                    : getpwuid_r( uid, &pwd, buffer, size, &pe);
+        if (result != ERANGE)
+            break;
+        size = 2 * size;
+        p = realloc( buffer == stack ? NULL : buffer, size);
+        if (p == NULL) {
+            result = ENOMEM;
+            break;
+        }
+        buffer = p;
+    }
+
+    if (result == 0) {
+        if (pe == NULL)
+            result = -1;
+        else {
+            lname = strlen( pwd.pw_name) + 1;
+            ldir = strlen( pwd.pw_dir) + 1;
+            entry->name = malloc( lname + ldir);
+            if (entry->name == NULL)
+                result = ENOMEM;
+            else {
+                entry->dir = entry->name + lname;
+                memcpy( entry->name, pwd.pw_name, lname);
+                memcpy( entry->dir, pwd.pw_dir, ldir);
+                entry->uid = pwd.pw_uid;
+                entry->gid = pwd.pw_gid;
+                entry->expire = nss_now() + NSS_CACHE_TTL;
+            }
+        }
+    }
+
+    if (buffer != stack)
+        free( buffer);
+    return result;
+}
+
+/*
+   Search the user of 'name' if not NULL or else of 'uid', first in the
+   cache then using NSS. Return 0 in case of success or an error code.
+   In case of success, the lock is held and must be released using
+   nss_unlock after use of the found entry, that is NULL if the user
+   doesn't exist.
+*/
+static int nss_lookup( uid_t uid, const char *name, struct nssentry **found)
+{
+    struct nssentry entry, *result;
+    int status;
+
+    nss_lock();
+    result = nss_search( uid, name);
+    if (result == NULL) {
+        /* not locked while waiting NSS */
+        nss_unlock();
+        status = nss_fetch( uid, name, &entry);
+        if (status > 0)
+            return status;
+        nss_lock();
+        if (status == 0) {
+            /* record the entry unless added meanwhile */
+            result = nss_search( uid, name);
+            if (result != NULL)
+                free( entry.name);
+            else {
+                if (nsscount == NSS_CACHE_COUNT)
+                    free( nsscache[--nsscount].name);
+                memmove( &nsscache[1], &nsscache[0],
+                                        nsscount * sizeof * nsscache);
+                nsscache[0] = entry;
+                nsscount++;
+                result = &nsscache[0];
+            }
+        }
+    }
+    *found = result;
+    return 0;
+}
+
 int pw_get( struct heap *heap, struct pwget **items)
 {
-    char buffer[BUFSIZE];
-    struct passwd entry, *pe;
+    struct nssentry *entry;
     int result;
     int n;
-    uid_t id;
 
     for( n = 0 ; items[n] != NULL ; n++ ) {
-        id = (uid_t)atoi(items[n]->id);
-        result = getpwuid_r( id, &entry, buffer, sizeof buffer, &pe);
+        result = nss_lookup( (uid_t)atoi(items[n]->id), NULL, &entry);
         if (result != 0) {
             while(items[n] != NULL) items[n++]->set = 0;
             return result;
         }
-        if (pe == NULL) 
+        if (entry == NULL) 
             items[n]->set = 0;
         else {
             items[n]->set = 1;
-            items[n]->user = heap_strdup( heap, pe->pw_name);
-            items[n]->home = heap_strdup( heap, pe->pw_dir);
+            items[n]->user = heap_strdup( heap, entry->name);
+            items[n]->home = heap_strdup( heap, entry->dir);
         }
+        nss_unlock();
     }
     return 0;
 }
 
 int pw_has_uid( uid_t uid)
 {
-    char buffer[BUFSIZE];
-    struct passwd entry, *pe;
+    struct nssentry *entry;
     int result;
 
-    result = getpwuid_r( uid, &entry, buffer, sizeof buffer, &pe);
-    return !result && pe;
+    result = nss_lookup( uid, NULL, &entry);
+    if (result != 0)
+        return 0;
+    result = entry != NULL;
+    nss_unlock();
+    return result;
+}
+
+unsigned long pw_generation()
+{
+    /* changes of NSS can't be detected: the users are taken as modified
+       after the time of validity of the cached users */
+    return (unsigned long)(nss_now() / NSS_CACHE_TTL);
 }
 
 int pw_get_uid( const char *name, uid_t *uid)
 {
-    char buffer[BUFSIZE];
-    struct passwd entry, *pe;
-    int result = getpwnam_r( name, &entry, buffer, sizeof buffer, &pe);
+    struct nssentry *entry;
+    int result = nss_lookup( 0, name, &entry);
     if (result == 0) {
-        if (pe == NULL) {
+        if (entry == NULL) {
             errno = EEXIST;
             result = -1;
         }
         else {
-            *uid = entry.pw_uid;
+            *uid = entry->uid;
         }
+        nss_unlock();
     }
     return result;
 }
 
 int pw_get_gid( const char *name, gid_t *gid)
 {
-    char buffer[BUFSIZE];
-    struct passwd entry, *pe;
-    int result = getpwnam_r( name, &entry, buffer, sizeof buffer, &pe);
+    struct nssentry *entry;
+    int result = nss_lookup( 0, name, &entry);
     if (result == 0) {
-        if (pe == NULL) {
+        if (entry == NULL) {
             errno = EEXIST;
             result = -1;
         }
         else {
-            *gid = entry.pw_gid;
+            *gid = entry->gid;
         }
+        nss_unlock();
     }
     return result;
 }
@@ -302,3 +820,218 @@ int main(int argc,char**argv) {
 #endif
 
 
+
+#ifdef TEST_PASSWD_STRESS
+/*
+   Resolves many users from many threads while the passwd file changes.
+   Compile with -DTEST_PASSWD_STRESS -DPASSWD_FILE=\"/tmp/passwd\" and
+   link with heap.c and buffer.c.
+*/
+#ifdef NOT_PASSWD_ONLY
+#error "TEST_PASSWD_STRESS needs the passwd file"
+#endif
+#include <stdio.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#define STRESS_USERS       2000
+#define STRESS_THREADS     8
+#define STRESS_LOOPS       20000
+#define STRESS_REWRITES    50
+
+static int stress_errors = 0;
+static int stress_stop = 0;
+
+/* write the passwd file with STRESS_USERS users, replacing it */
+static void stress_write()
+{
+    char tmp[sizeof pwfile + 8];
+    FILE *file;
+    int i;
+
+    snprintf(tmp, sizeof tmp, "%s.tmp", pwfile);
+    file = fopen(tmp, "w");
+    if (file == NULL) {
+        perror(tmp);
+        exit(1);
+    }
+    for (i = 0 ; i < STRESS_USERS ; i++)
+        fprintf(file, "user%d:x:%d:%d::/home/user%d:/bin/sh\n",
+                                            i, 10000 + i, 20000 + i, i);
+    fclose(file);
+    rename(tmp, pwfile);
+}
+
+static void *stress_rewriter(void *arg)
+{
+    int i;
+
+    for (i = 0 ; i < STRESS_REWRITES
+                && !__atomic_load_n(&stress_stop, __ATOMIC_SEQ_CST) ; i++) {
+        stress_write();
+        usleep(1000);
+    }
+    return NULL;
+}
+
+static void *stress_resolver(void *arg)
+{
+    struct heap heap;
+    char name[32], id[32], home[32];
+    struct pwget pw, *ppw[2] = { &pw, NULL };
+    unsigned seed = (unsigned)(size_t)arg;
+    uid_t u;
+    gid_t g;
+    int i, k, errors = 0;
+
+    for (i = 0 ; i < STRESS_LOOPS ; i++) {
+        k = (int)(rand_r(&seed) % STRESS_USERS);
+        snprintf(name, sizeof name, "user%d", k);
+        snprintf(id, sizeof id, "%d", 10000 + k);
+        snprintf(home, sizeof home, "/home/user%d", k);
+        if (pw_get_uid(name, &u) || u != (uid_t)(10000 + k))
+            errors++;
+        if (pw_get_gid(name, &g) || g != (gid_t)(20000 + k))
+            errors++;
+        if (!pw_has_uid((uid_t)(10000 + k)) || pw_has_uid(5))
+            errors++;
+        heap_create(&heap, 256);
+        pw.id = id;
+        if (pw_get(&heap, ppw) || !pw.set
+                || strcmp(heap_address(&heap, pw.user), name)
+                || strcmp(heap_address(&heap, pw.home), home))
+            errors++;
+        heap_destroy(&heap);
+    }
+    __atomic_add_fetch(&stress_errors, errors, __ATOMIC_SEQ_CST);
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    pthread_t rewriter, resolvers[STRESS_THREADS];
+    int i;
+
+    stress_write();
+    pthread_create(&rewriter, NULL, stress_rewriter, NULL);
+    for (i = 0 ; i < STRESS_THREADS ; i++)
+        pthread_create(&resolvers[i], NULL, stress_resolver,
+                                                    (void*)(size_t)(i + 1));
+    for (i = 0 ; i < STRESS_THREADS ; i++)
+        pthread_join(resolvers[i], NULL);
+    __atomic_store_n(&stress_stop, 1, __ATOMIC_SEQ_CST);
+    pthread_join(rewriter, NULL);
+    unlink(pwfile);
+
+    printf("%d threads, %d lookups each: %d errors\n",
+                        STRESS_THREADS, 4 * STRESS_LOOPS, stress_errors);
+    return stress_errors != 0;
+}
+#endif
+
+#ifdef BENCH_PASSWD
+/*
+   Measures the reading of a passwd file of 50000 lines.
+   Compile with -DBENCH_PASSWD -DPASSWD_FILE=\"/tmp/passwd\" and
+   link with heap.c and buffer.c.
+*/
+#ifdef NOT_PASSWD_ONLY
+#error "BENCH_PASSWD needs the passwd file"
+#endif
+#include <stdio.h>
+#include <unistd.h>
+
+#define BENCH_LINES    50000
+#define BENCH_PASSES   20
+#define BENCH_LOOKUPS  1000000
+
+/* the former reader, scanning byte per byte */
+static int bench_rdpw_bytes( struct pwcursor *cursor)
+{
+    int col = 0;
+    const char *head = cursor->buffer.buffer + cursor->pos;
+    const char *end = cursor->buffer.buffer + cursor->buffer.length;
+    while (head != end) {
+        cursor->starts[col] = head;
+        while(head!=end && *head!=':' && *head!='\n') head++;
+        cursor->lengths[col] = head - cursor->starts[col];
+        col++;
+        if (col == 7) {
+            if (head==end || *head=='\n') {
+                if (head!=end) head++;
+                cursor->pos = head - cursor->buffer.buffer;
+                return 1;
+            }
+            while (head!=end && *head!='\n') head++;
+            if (head!=end) head++;
+            col = 0;
+        }
+        else if (head != end && *head++=='\n')
+            col = 0;
+    }
+    cursor->pos = head - cursor->buffer.buffer;
+    return 0;
+}
+
+static double bench_now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* time of a pass on the file using 'reader', summing the uids */
+static double bench_pass(int (*reader)(struct pwcursor*), unsigned *sum)
+{
+    struct pwcursor cursor;
+    double start = bench_now();
+    int i;
+
+    for (i = 0 ; i < BENCH_PASSES ; i++) {
+        oppw(&cursor);
+        while (reader(&cursor))
+            *sum += (unsigned)atoi(cursor.starts[iuid]);
+        clpw(&cursor);
+    }
+    return (bench_now() - start) / BENCH_PASSES;
+}
+
+int main(int argc, char **argv)
+{
+    struct pwindex *index;
+    FILE *file;
+    unsigned sum1 = 0, sum2 = 0;
+    double start;
+    int i, found = 0;
+
+    file = fopen(pwfile, "w");
+    if (file == NULL) {
+        perror(pwfile);
+        return 1;
+    }
+    for (i = 0 ; i < BENCH_LINES ; i++)
+        fprintf(file, "user%d:x:%d:%d:User number %d:/home/user%d:/bin/sh\n",
+                                        i, 100000 + i, 100000 + i, i, i);
+    fclose(file);
+
+    printf("byte loop:   %8.3f ms per pass\n",
+                            1e3 * bench_pass(bench_rdpw_bytes, &sum1));
+    printf("word scan:   %8.3f ms per pass\n",
+                            1e3 * bench_pass(rdpw, &sum2));
+    if (sum1 != sum2)
+        abort();
+
+    start = bench_now();
+    index = pwacquire();
+    printf("index build: %8.3f ms\n", 1e3 * (bench_now() - start));
+    pwrelease(index);
+
+    start = bench_now();
+    for (i = 0 ; i < BENCH_LOOKUPS ; i++)
+        found += pw_has_uid((uid_t)(100000 + i % BENCH_LINES));
+    printf("lookups:     %8.0f pw_has_uid/s\n",
+                            BENCH_LOOKUPS / (bench_now() - start));
+    unlink(pwfile);
+    return found != BENCH_LOOKUPS;
+}
+#endif
@@ -36,5 +36,8 @@ int pw_get_uid( const char *name, uid_t *uid);
 int pw_get_gid( const char *name, gid_t *gid);
 int pw_has_uid( uid_t uid);
 
+/* generation of the users, changed when they are possibly modified */
+unsigned long pw_generation();
+
 #endif
 
@@ -28,6 +28,7 @@
 #endif
 
 #include <stdlib.h>
+#include <stdint.h>
 #include <memory.h>
 
 #ifndef INITIAL_SCRATCH_CAPACITY
@@ -40,132 +41,788 @@
 
 #define INSTANCIATE 1
 #if INSTANCIATE
-#define SET_CAPACITY        97
-#define HASHCODE_INIT       5381
-#define HASHCODE_NEXT(H,C)  (((H) << 5) + (H) + (C))
+#define SET_INITIAL_CAPACITY  16     /* initial count of slots of a table */
+#define SET_ARENA_SIZE        1024   /* size of the chunks of the arena */
+#define HANDLE_BITS           10     /* log2 of the count of handles per page */
+#define HANDLE_PAGES          16384  /* count of pages of handles */
 #endif
 
 #ifndef NOT_MULTI_THREAD_SAFE
 #include <pthread.h>
+#define SET_STRIPES           16
+#else
+#define SET_STRIPES           1
+#endif
+
+#if (SET_INITIAL_CAPACITY & (SET_INITIAL_CAPACITY - 1)) != 0
+#error "bad value for SET_INITIAL_CAPACITY"
 #endif
 
-#if !(defined(NOT_MULTI_THREAD_SAFE) || INSTANCIATE)
+#include "atomic.h"
+#include "scratch.h"
+
+#ifndef NOT_MULTI_THREAD_SAFE
 static __thread void *global_scratch = NULL;
+/* the key whose destructor frees the scratch area of exiting threads */
+static pthread_key_t scratch_key;
+static pthread_once_t scratch_once = PTHREAD_ONCE_INIT;
+static int scratch_keyed = 0;
 #else
 static void *global_scratch = NULL;
 #endif
-#if INSTANCIATE && !defined(NOT_MULTI_THREAD_SAFE)
-static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+
+#ifndef NOT_MULTI_THREAD_SAFE
+/* create the key of the scratch areas */
+static void create_scratch_key()
+{
+    scratch_keyed = pthread_key_create(&scratch_key, free) == 0;
+}
 #endif
 
+/* record 'scratch' as the scratch area of the thread */
+static void set_scratch( void *scratch)
+{
+    global_scratch = scratch;
+#ifndef NOT_MULTI_THREAD_SAFE
+    pthread_once(&scratch_once, create_scratch_key);
+    if (scratch_keyed)
+        pthread_setspecific(scratch_key, scratch);
+#endif
+}
+
 #if INSTANCIATE
-/* structure for recording items in the hash map */
-struct set_item {
-    struct set_item *next;        /* chain to next item */
-    size_t hashcode;                /* hash of the string */
+/* slot of the open addressing tables */
+struct slot {
+    size_t hashcode;              /* hash of the string */
     size_t length;                /* length of the string including null */
+    const char *string;           /* the string or NULL if the slot is free */
+};
+
+/* table of slots */
+struct table {
+    struct table *previous;       /* the replaced table */
+    size_t capacity;              /* count of slots (a power of 2) */
+    struct slot slots[];
+};
+
+/* chunk of the arena of the strings */
+struct chunk {
+    struct chunk *next;           /* the previous chunk */
+    size_t size;                  /* size of the chunk */
+    size_t used;                  /* used size of the chunk */
+};
+
+/* a stripe of the set of strings */
+struct stripe {
+#ifndef NOT_MULTI_THREAD_SAFE
+    pthread_mutex_t mutex;        /* the mutex for adding strings */
+#endif
+    struct table *table;          /* the current table */
+    struct chunk *chunks;         /* the arena, current chunk first */
+    size_t count;                 /* count of strings */
+    size_t bytes;                 /* count of allocated bytes */
+    unsigned long misses;         /* count of strings not found */
+};
+
+/* count of strings found by a thread, only written by its thread */
+struct hits {
+    struct hits *next;            /* the count of another thread */
+    unsigned long count;          /* count of strings found */
 };
 
-/* the array of recorded strings */
-static struct set_item *global_path_set[SET_CAPACITY]; /* initialized to  zeros */
+/* the recorded strings, dispatched by hash code in stripes */
+#ifndef NOT_MULTI_THREAD_SAFE
+static struct stripe stripes[SET_STRIPES] = {
+    [0 ... SET_STRIPES - 1] = { .mutex = PTHREAD_MUTEX_INITIALIZER }
+};
+#else
+static struct stripe stripes[SET_STRIPES];
+#endif
+
+/* the counts of strings found, summed by scratch_stats */
+#ifndef NOT_MULTI_THREAD_SAFE
+static __thread struct hits *thread_hits = NULL;
+static struct hits *living_hits = NULL;  /* the counts of the threads */
+static unsigned long retired_hits = 0;   /* the counts of exited threads */
+static pthread_mutex_t hits_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t hits_key;
+static pthread_once_t hits_once = PTHREAD_ONCE_INIT;
+static int hits_keyed = 0;
+#else
+static unsigned long retired_hits = 0;
+#endif
+
+/* count of releases of the strings */
+static size_t generation = 0;
+
+/* rotation of the word 'x' by 'n' bits */
+#define ROTATE(x,n)           (((x) << (n)) | ((x) >> (64 - (n))))
+
+/* hash code of the 'string' of 'length', computed by words of 64 bits */
+static inline size_t hash(const char *string, size_t length)
+{
+    uint64_t result, word;
+
+    result = (uint64_t)length * 0x9e3779b97f4a7c15ULL;
+    while (length >= sizeof word) {
+        memcpy(&word, string, sizeof word);
+        result = (ROTATE(result, 23) ^ word) * 0x9e3779b97f4a7c15ULL;
+        string += sizeof word;
+        length -= sizeof word;
+    }
+    word = 0;
+    memcpy(&word, string, length);
+    result = (ROTATE(result, 23) ^ word) * 0x9e3779b97f4a7c15ULL;
+
+    /* final mixing of the bits */
+    result ^= result >> 33;
+    result *= 0xff51afd7ed558ccdULL;
+    result ^= result >> 33;
+    return (size_t)result;
+}
+
+/* index of the first slot to probe in 'table' for 'hashcode' */
+static inline size_t home(struct table *table, size_t hashcode)
+{
+    return (hashcode / SET_STRIPES) & (table->capacity - 1);
+}
+
+/* search in the 'table' the 'string' of 'length' and 'hashcode' */
+static const char *search(struct table *table, const char *string,
+                                            size_t length, size_t hashcode)
+{
+    struct slot *slot;
+    const char *result;
+    size_t index, mask;
+
+    if (!table)
+        return NULL;
+
+    mask = table->capacity - 1;
+    index = home(table, hashcode);
+    for (;;) {
+        slot = &table->slots[index];
+        result = _ATOMIC_GET_(&slot->string);
+        if (!result
+                || (slot->hashcode == hashcode
+                    && slot->length == length
+                    && 0 == memcmp(string, result, length)))
+            return result;
+        index = (index + 1) & mask;
+    }
+}
+
+/* put in the 'table' the 'string' of 'length' and 'hashcode' */
+static void place(struct table *table, const char *string,
+                                            size_t length, size_t hashcode)
+{
+    struct slot *slot;
+    size_t index, mask;
+
+    mask = table->capacity - 1;
+    index = home(table, hashcode);
+    while (table->slots[index].string)
+        index = (index + 1) & mask;
+    slot = &table->slots[index];
+    slot->hashcode = hashcode;
+    slot->length = length;
+    _ATOMIC_SET_(&slot->string, string);
+}
+
+/* replace the table of the 'stripe' by a bigger one.
+The replaced table is kept because it can still be read. */
+static struct table *grow(struct stripe *stripe)
+{
+    struct table *table, *previous;
+    size_t capacity, index, size;
+
+    previous = stripe->table;
+    capacity = previous ? 2 * previous->capacity : SET_INITIAL_CAPACITY;
+    size = sizeof * table + capacity * sizeof * table->slots;
+    table = calloc(1, size);
+    if (!table)
+        return NULL;
+
+    table->previous = previous;
+    table->capacity = capacity;
+    if (previous)
+        for (index = 0 ; index < previous->capacity ; index++)
+            if (previous->slots[index].string)
+                place(table, previous->slots[index].string,
+                                previous->slots[index].length,
+                                previous->slots[index].hashcode);
+
+    stripe->bytes += size;
+    _ATOMIC_SET_(&stripe->table, table);
+    return table;
+}
+
+/* the strings by handles, in pages allocated on need */
+static const char **handle_pages[HANDLE_PAGES];
+static size_t handle_count = 0;
+static size_t handle_bytes = 0;
+#ifndef NOT_MULTI_THREAD_SAFE
+static pthread_mutex_t handle_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/* return a new handle for the 'string' or 0 if not possible */
+static size_t newhandle(const char *string)
+{
+    const char **page;
+    size_t handle, index;
+
+    handle = _ATOMIC_INC_(&handle_count);
+    index = handle >> HANDLE_BITS;
+    if (index >= HANDLE_PAGES)
+        return 0;
+
+    page = _ATOMIC_GET_(&handle_pages[index]);
+    if (!page) {
+#ifndef NOT_MULTI_THREAD_SAFE
+        pthread_mutex_lock(&handle_mutex);
+#endif
+        page = handle_pages[index];
+        if (!page) {
+            page = calloc((size_t)1 << HANDLE_BITS, sizeof * page);
+            if (page) {
+                _ATOMIC_SET_(&handle_bytes, handle_bytes
+                            + ((size_t)1 << HANDLE_BITS) * sizeof * page);
+                _ATOMIC_SET_(&handle_pages[index], page);
+            }
+        }
+#ifndef NOT_MULTI_THREAD_SAFE
+        pthread_mutex_unlock(&handle_mutex);
+#endif
+        if (!page)
+            return 0;
+    }
+
+    _ATOMIC_SET_(&page[handle & (((size_t)1 << HANDLE_BITS) - 1)], string);
+    return handle;
+}
+
+/* copy in the arena of 'stripe' the 'string' of 'length'
+preceded by its handle */
+static const char *store(struct stripe *stripe, const char *string,
+                                                            size_t length)
+{
+    struct chunk *chunk;
+    size_t *header;
+    char *result;
+    size_t size, need;
+
+    /* keep the headers aligned */
+    need = sizeof * header + length;
+    need = (need + sizeof * header - 1) & ~(sizeof * header - 1);
+
+    chunk = stripe->chunks;
+    if (!chunk || chunk->size - chunk->used < need) {
+        size = need > SET_ARENA_SIZE ? need : SET_ARENA_SIZE;
+        chunk = malloc(size + sizeof * chunk);
+        if (!chunk)
+            return NULL;
+        chunk->next = stripe->chunks;
+        chunk->size = size;
+        chunk->used = 0;
+        stripe->chunks = chunk;
+        stripe->bytes += size + sizeof * chunk;
+    }
+    header = (size_t *)((char *)(chunk + 1) + chunk->used);
+    chunk->used += need;
+    result = (char *)(header + 1);
+    memcpy(result, string, length);
+    *header = newhandle(result);
+    return result;
+}
+
+#ifndef NOT_MULTI_THREAD_SAFE
+/* remove the 'value' of the hits of an exiting thread */
+static void retire_hits(void *value)
+{
+    struct hits *hits = value, **prev;
+
+    pthread_mutex_lock(&hits_mutex);
+    retired_hits += hits->count;
+    prev = &living_hits;
+    while (*prev != hits)
+        prev = &(*prev)->next;
+    *prev = hits->next;
+    pthread_mutex_unlock(&hits_mutex);
+    thread_hits = NULL;
+    free(hits);
+}
+
+/* create the key of the hits */
+static void create_hits_key()
+{
+    hits_keyed = pthread_key_create(&hits_key, retire_hits) == 0;
+}
+
+/* return the hits of the thread, created at its first use, or NULL */
+static struct hits *enroll_hits()
+{
+    struct hits *hits;
+
+    pthread_once(&hits_once, create_hits_key);
+    if (!hits_keyed)
+        return NULL;
+    hits = calloc(1, sizeof * hits);
+    if (hits == NULL)
+        return NULL;
+    pthread_mutex_lock(&hits_mutex);
+    hits->next = living_hits;
+    living_hits = hits;
+    pthread_mutex_unlock(&hits_mutex);
+    pthread_setspecific(hits_key, hits);
+    thread_hits = hits;
+    return hits;
+}
+#endif
+
+/* count a string found, without shared write */
+static inline void count_hit()
+{
+#ifndef NOT_MULTI_THREAD_SAFE
+    struct hits *hits = thread_hits;
+
+    if (hits == NULL) {
+        hits = enroll_hits();
+        if (hits == NULL)
+            return;
+    }
+    _RELAXED_SET_(&hits->count, hits->count + 1);
+#else
+    retired_hits++;
+#endif
+}
 
 /* instanciate (or retrieve an instance) of the 'string' that
 is granted to have the 'length' including terminating null and a
-hash code 'hashcode' */
+hash code 'hashcode'.
+The strings are never removed and are published atomically in their
+slots: the search is done without lock and only the addition of a
+string locks its stripe. */
 static const char *instantiate(const char *string, size_t length, size_t hashcode)
 {
-    struct set_item **pp, *item;
-    char *result;
+    struct stripe *stripe;
+    struct table *table;
+    const char *result;
+
+    /* search without lock */
+    stripe = &stripes[hashcode % SET_STRIPES];
+    result = search(_ATOMIC_GET_(&stripe->table), string, length, hashcode);
+    if (result) {
+        count_hit();
+        return result;
+    }
+
+#ifndef NOT_MULTI_THREAD_SAFE
+    pthread_mutex_lock(&stripe->mutex);
+#endif
 
-    /* get first item in the table */
-    pp = &global_path_set[hashcode % SET_CAPACITY];
-    result = 0;
-    do {
-        /* inspect the item */
-        item = *pp;
-        if (!item) {
-            /* no item: create it */
-            item = malloc(length + sizeof * item);
-            if (!item)
-                return NULL;
-            /* init it */
-            item->next = 0;
-            item->hashcode = hashcode;
-            item->length = length;
-            result = (char *)(item + 1);
-            memcpy(result, string, length);
-            /* record it */
-            *pp = item;
-        } else if (item->hashcode == hashcode
-                && item->length == length
-                && 0 == strcmp(string, (const char *)(item + 1))) {
-            /* item found */
-            result = (char *)(item + 1);
-        } else {
-            /* try the next */
-            pp = &item->next;
+    /* search again (the string may have been added) */
+    table = stripe->table;
+    result = search(table, string, length, hashcode);
+    if (!result) {
+        /* keep the load factor under 3/4 */
+        if (!table || 4 * (stripe->count + 1) > 3 * table->capacity)
+            table = grow(stripe);
+        if (table) {
+            result = store(stripe, string, length);
+            if (result) {
+                place(table, result, length, hashcode);
+                stripe->count++;
+                stripe->misses++;
+            }
         }
-    } while (!result);
+    }
+    else
+        count_hit();
+
+#ifndef NOT_MULTI_THREAD_SAFE
+    pthread_mutex_unlock(&stripe->mutex);
+#endif
 
     return result;
 }
 #endif
 
-/* CAUTION: in a multitheaded context, it is expected that
-=========== the function scratchcat is call under a mutex. 
-If it is not the case please check for initializing 'tlskey' 
-only one time before use of it. */
+void scratch_stats(struct scratch_stats *stats)
+{
+#if INSTANCIATE
+#ifndef NOT_MULTI_THREAD_SAFE
+    struct hits *hits;
+#endif
+    struct stripe *stripe;
+    struct table *table;
+    size_t index, mask, probes;
+    int i;
+#endif
 
-#if INSTANCIATE && !defined(NOT_MULTI_THREAD_SAFE)
-static const char *_scratchcat( int ispath, const char **strings);
+    memset(stats, 0, sizeof * stats);
+    stats->capacity = global_scratch == NULL ? 0 : *((size_t*)global_scratch);
+#if INSTANCIATE
+    for (i = 0 ; i < SET_STRIPES ; i++) {
+        stripe = &stripes[i];
+#ifndef NOT_MULTI_THREAD_SAFE
+        pthread_mutex_lock(&stripe->mutex);
+#endif
+        stats->entries += stripe->count;
+        stats->bytes += stripe->bytes;
+        stats->misses += stripe->misses;
+        table = stripe->table;
+        if (table) {
+            mask = table->capacity - 1;
+            for (index = 0 ; index < table->capacity ; index++)
+                if (table->slots[index].string) {
+                    probes = 1 + ((index - home(table,
+                                table->slots[index].hashcode)) & mask);
+                    stats->probes += probes;
+                    stats->histogram[probes < SCRATCH_HISTOGRAM ?
+                                        probes - 1 : SCRATCH_HISTOGRAM - 1]++;
+                }
+        }
+#ifndef NOT_MULTI_THREAD_SAFE
+        pthread_mutex_unlock(&stripe->mutex);
+#endif
+    }
+    stats->bytes += _ATOMIC_GET_(&handle_bytes);
 
-const char *scratchcat( int ispath, const char **strings)
+    /* sum the hits of the threads */
+#ifndef NOT_MULTI_THREAD_SAFE
+    pthread_mutex_lock(&hits_mutex);
+    stats->hits = retired_hits;
+    for (hits = living_hits ; hits != NULL ; hits = hits->next)
+        stats->hits += _RELAXED_GET_(&hits->count);
+    pthread_mutex_unlock(&hits_mutex);
+#else
+    stats->hits = retired_hits;
+#endif
+#endif
+}
+
+void scratch_trim(int strings)
 {
-    const char *result;
-    pthread_mutex_lock(&mutex);
-    result = _scratchcat( ispath, strings);
-    pthread_mutex_unlock(&mutex);
-    return result;
+#if INSTANCIATE
+    struct stripe *stripe;
+    struct table *table;
+    struct chunk *chunk;
+    size_t index;
+    int i;
+#endif
+
+    /* release the scratch area of the thread */
+    free(global_scratch);
+    set_scratch(NULL);
+
+#if INSTANCIATE
+    if (!strings)
+        return;
+
+    /* release the recorded strings */
+    _ATOMIC_INC_(&generation);
+    for (i = 0 ; i < SET_STRIPES ; i++) {
+        stripe = &stripes[i];
+#ifndef NOT_MULTI_THREAD_SAFE
+        pthread_mutex_lock(&stripe->mutex);
+#endif
+        while ((table = stripe->table) != NULL) {
+            stripe->table = table->previous;
+            free(table);
+        }
+        while ((chunk = stripe->chunks) != NULL) {
+            stripe->chunks = chunk->next;
+            free(chunk);
+        }
+        stripe->count = 0;
+        stripe->bytes = 0;
+#ifndef NOT_MULTI_THREAD_SAFE
+        pthread_mutex_unlock(&stripe->mutex);
+#endif
+    }
+
+    /* release the handles */
+#ifndef NOT_MULTI_THREAD_SAFE
+    pthread_mutex_lock(&handle_mutex);
+#endif
+    for (index = 0 ; index < HANDLE_PAGES ; index++) {
+        free(handle_pages[index]);
+        handle_pages[index] = NULL;
+    }
+    handle_count = 0;
+    handle_bytes = 0;
+#ifndef NOT_MULTI_THREAD_SAFE
+    pthread_mutex_unlock(&handle_mutex);
+#endif
+#endif
 }
 
-static const char *_scratchcat( int ispath, const char **strings)
+size_t scratch_generation()
+{
+#if INSTANCIATE
+    return _ATOMIC_GET_(&generation);
 #else
-const char *scratchcat( int ispath, const char **strings)
+    return 0;
 #endif
+}
+
+size_t scratch_handle(const char *string)
 {
-    void *scratch, *p;
-    char *result;
-    size_t length, capacity;
-    const char *instr;
-    char c, pc;
 #if INSTANCIATE
-    size_t hashcode = HASHCODE_INIT;
+    return string ? ((const size_t *)string)[-1] : 0;
+#else
+    return 0;
 #endif
+}
 
-    /* get the recorded pointer on scrtch area */
-    scratch = global_scratch;
+const char *scratch_string(size_t handle)
+{
+#if INSTANCIATE
+    const char **page;
+    size_t index;
 
-    /* create the scratch area if needed */
-    if (scratch == NULL) {
-        capacity = INITIAL_SCRATCH_CAPACITY;
-        p = malloc( capacity + sizeof(size_t));
+    index = handle >> HANDLE_BITS;
+    if (handle == 0 || index >= HANDLE_PAGES)
+        return NULL;
+    page = _ATOMIC_GET_(&handle_pages[index]);
+    if (!page)
+        return NULL;
+    return _ATOMIC_GET_(&page[handle & (((size_t)1 << HANDLE_BITS) - 1)]);
+#else
+    return NULL;
+#endif
+}
+
+/* The scratch area is local to the thread. */
+
+/* return the scratch area with a capacity of at least 'size' bytes */
+static char *reserve( size_t size)
+{
+    void *scratch, *p;
+    size_t capacity;
+
+    scratch = global_scratch;
+    capacity = scratch == NULL ? 0 : *((size_t*)scratch);
+    if (capacity < size) {
+        if (capacity == 0)
+            capacity = INITIAL_SCRATCH_CAPACITY;
+        while (capacity < size)
+            capacity = 2 * capacity;
+        p = realloc( scratch, capacity + sizeof(size_t));
         if (p == NULL)
             return NULL;
         *((size_t*)p) = capacity;
         scratch = p;
-        global_scratch = p;
+        set_scratch( p);
     }
+    return (char*)(1+((size_t*)scratch));
+}
 
-    /* set local data for scratch area */
-    capacity = *((size_t*)scratch);
-    result = (char*)(1+((size_t*)scratch));
-    length = 0;
+#ifndef SCRATCHCATV_LENGTHS
+#define SCRATCHCATV_LENGTHS   32
+#endif
+
+const char *scratchcatv( int ispath, const char *string, const char *const *strings, size_t count)
+{
+    size_t lengths[SCRATCHCATV_LENGTHS];
+    size_t index, length, size, first;
+    const char *instr;
+    char *result, pc;
+
+    /* compute the length of the result (at most one '/' per string) */
+    first = string == NULL ? 0 : strlen( string);
+    length = first + 2;
+    for (index = 0 ; index < count ; index++) {
+        size = strings[index] == NULL ? 0 : strlen( strings[index]);
+        if (index < SCRATCHCATV_LENGTHS)
+            lengths[index] = size;
+        length += size + 1;
+    }
+
+    result = reserve( length);
+    if (result == NULL)
+        return NULL;
 
     /* copy the strings */
-    c = 0;
+    length = 0;
     pc = 1;
-    while(pc) {
+    for (index = 0 ; index <= count ; index++) {
+        if (index == 0) {
+            instr = string;
+            size = first;
+        }
+        else {
+            instr = strings[index - 1];
+            size = instr == NULL ? 0
+                : index <= SCRATCHCATV_LENGTHS ? lengths[index - 1]
+                : strlen( instr);
+        }
+        if (size == 0)
+            continue;
+        if (ispath) {
+            if (*instr != '/' && pc != '/')
+                result[length++] = '/';
+            else if (*instr == '/' && pc == '/') {
+                instr++;
+                if (--size == 0)
+                    continue;
+            }
+        }
+        memcpy( result + length, instr, size);
+        length += size;
+        pc = instr[size - 1];
+    }
+    result[length++] = 0;
 
+#if INSTANCIATE
+    return instantiate(result, length, hash(result, length));
+#else
+    return result;
+#endif
+}
+
+const char *scratchcat( int ispath, const char **strings)
+{
+    size_t count;
+
+    for (count = 0 ; strings[count] != NULL ; count++);
+    if (count == 0)
+        return scratchcatv( ispath, NULL, NULL, 0);
+    return scratchcatv( ispath, strings[0], (const char *const *)strings + 1, count - 1);
+}
+
+size_t scratchcpy( int ispath, const char **strings, char *buffer, size_t size)
+{
+    size_t length;
+    const char *instr;
+    char c, pc;
+
+    length = 0;
+    pc = 1;
+    while ((instr = *strings++) != NULL) {
+        c = *instr;
+        if (c == 0)
+            continue;
+        if (ispath) {
+            if (c != '/' && pc != '/') {
+                if (length < size)
+                    buffer[length] = '/';
+                length++;
+            }
+            else if (c == '/' && pc == '/')
+                instr++;
+        }
+        while ((c = *instr++) != 0) {
+            if (length < size)
+                buffer[length] = c;
+            length++;
+            pc = c;
+        }
+    }
+
+    /* terminate the string */
+    if (size != 0)
+        buffer[length < size ? length : size - 1] = 0;
+    return length;
+}
+
+#ifdef TEST_SCRATCH
+#include <stdio.h>
+int main(int argc, const char**argv) {
+    int ispath, iter, i;
+    argv++;
+    ispath = argv[0] && argv[0][0] == '-' && argv[0][1] == 'p';
+    for (i = 0 ; i < 2 ; i++) {
+        iter = ispath;
+        while (iter < argc) {
+            const char *p = scratchcat(ispath,argv+iter++);
+            printf("%p: %s\n",p,p);
+        }
+    }
+    {
+        struct scratch_stats stats;
+        scratch_stats(&stats);
+        printf("entries=%zu bytes=%zu probes=%zu hits=%lu misses=%lu\n",
+                stats.entries, stats.bytes, stats.probes,
+                stats.hits, stats.misses);
+    }
+    return 0;
+}
+#endif
+
+#ifdef BENCH_SCRATCH
+#include <stdio.h>
+#include <time.h>
+
+#define BENCH_DURATION  1   /* duration in seconds of each measure */
+#define BENCH_PATHS     64  /* count of distinct paths built */
+
+static volatile int bench_stop;
+
+static void *bench_thread(void *arg)
+{
+    const char *names[BENCH_PATHS];
+    const char *array[4];
+    unsigned long count = 0;
+    char name[BENCH_PATHS][16];
+    int i;
+
+    for (i = 0 ; i < BENCH_PATHS ; i++) {
+        snprintf(name[i], sizeof name[i], "file-%d", i);
+        names[i] = name[i];
+    }
+    array[0] = "/opt/usr/home/owner";
+    array[1] = "apps_rw";
+    array[3] = NULL;
+    while (!bench_stop) {
+        array[2] = names[count % BENCH_PATHS];
+        if (!scratchcat(1, array))
+            abort();
+        count++;
+    }
+    *(unsigned long *)arg = count;
+    return NULL;
+}
+
+int main(int argc, const char**argv) {
+    static const int counts[] = { 1, 2, 4, 8, 16 };
+    pthread_t threads[16];
+    unsigned long results[16], total;
+    struct timespec ts = { BENCH_DURATION, 0 };
+    int i, j;
+
+    for (i = 0 ; i < (int)(sizeof counts / sizeof * counts) ; i++) {
+        bench_stop = 0;
+        for (j = 0 ; j < counts[i] ; j++)
+            pthread_create(&threads[j], NULL, bench_thread, &results[j]);
+        nanosleep(&ts, NULL);
+        bench_stop = 1;
+        total = 0;
+        for (j = 0 ; j < counts[i] ; j++) {
+            pthread_join(threads[j], NULL);
+            total += results[j];
+        }
+        printf("%2d threads: %10lu paths/s\n", counts[i], total / BENCH_DURATION);
+    }
+    return 0;
+}
+#endif
+
+#ifdef BENCH_SCRATCHCAT
+#include <stdio.h>
+#include <time.h>
+
+#define BENCH_COUNT     2000000   /* count of paths built per measure */
+
+/* the former implementation, copying byte per byte */
+static const char *bytecat( int ispath, const char **strings)
+{
+    static char result[4096];
+    size_t length = 0, hashcode = 5381;
+    const char *instr = NULL;
+    char c = 0, pc = 1;
+
+    while(pc) {
         if (c == 0) {
             instr = *strings++;
             if (instr != NULL) {
@@ -190,49 +847,40 @@ const char *scratchcat( int ispath, const char **strings)
                 continue;
             instr++;
         }
-
-        /* extend the scratch area if needed */
-        if (length == capacity) {
-            capacity = 2 * capacity;
-            p = realloc( scratch, capacity + sizeof(size_t));
-            if (p == NULL)
-                return NULL;
-            *((size_t*)p) = capacity;
-            if (p != scratch) {
-                scratch = p;
-                global_scratch = p;
-                result = (char*)(1+((size_t*)p));
-            }
-        }
-
-        /* append the char */
+        if (length == sizeof result)
+            return NULL;
         pc = result[length++] = c;
-#if INSTANCIATE
-        hashcode = HASHCODE_NEXT(hashcode, (size_t)c);
-#endif
+        hashcode = ((hashcode << 5) + hashcode) + (size_t)c;
     }
-
-#if INSTANCIATE
     return instantiate(result, length, hashcode);
-#else
-    return result;
-#endif
 }
 
+static double measure(const char *(*cat)(int, const char **), const char **array)
+{
+    struct timespec start, end;
+    int i;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0 ; i < BENCH_COUNT ; i++)
+        if (!cat(1, array))
+            abort();
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (double)BENCH_COUNT / ((double)(end.tv_sec - start.tv_sec)
+                            + (double)(end.tv_nsec - start.tv_nsec) * 1e-9);
+}
 
-#ifdef TEST_SCRATCH
-#include <stdio.h>
 int main(int argc, const char**argv) {
-    int ispath, iter, i;
-    argv++;
-    ispath = argv[0] && argv[0][0] == '-' && argv[0][1] == 'p';
-    for (i = 0 ; i < 2 ; i++) {
-        iter = ispath;
-        while (iter < argc) {
-            const char *p = scratchcat(ispath,argv+iter++);
-            printf("%p: %s\n",p,p);
-        }
-    }
+    const char *array[] = {
+        "/opt/usr/home/owner/apps_rw/org.example.application.with.long.name",
+        "shared/data/documents/collections/2025/",
+        "/thumbnails/large/very-long-file-name-for-the-benchmark.png",
+        NULL
+    };
+
+    if (strcmp(bytecat(1, array), scratchcat(1, array)))
+        abort();
+    printf("byte loop: %10.0f paths/s\n", measure(bytecat, array));
+    printf("spans:     %10.0f paths/s\n", measure(scratchcat, array));
     return 0;
 }
 #endif
@@ -45,6 +45,72 @@
 */
 const char *scratchcat( int ispath, const char **strings);
 
+/*
+ Same as scratchcat for the concatenation of the 'string' followed by
+ the 'count' strings of the array 'strings'. The NULL strings are ignored.
+*/
+const char *scratchcatv( int ispath, const char *string, const char *const *strings, size_t count);
+
+/*
+ Copy in 'buffer' of 'size' bytes the concatenation of the strings of the
+ array 'strings' exactly as scratchcat does but without recording it.
+ The copy is truncated if needed but, if 'size' isn't zero, the buffer
+ always receives a terminating null.
+
+ Return the length of the full concatenation (terminating null excluded).
+ The copy is truncated if the returned value is greater or equal to 'size'.
+*/
+size_t scratchcpy( int ispath, const char **strings, char *buffer, size_t size);
+
+/*
+ Return the handle of the 'string' that must be a string returned by
+ scratchcat or scratchcatv. The handles are small positive integers given
+ in order of recording of the strings. Return 0 if 'string' is NULL or
+ has no handle.
+*/
+size_t scratch_handle(const char *string);
+
+/*
+ Return the string of 'handle' or NULL if 'handle' isn't a valid handle.
+*/
+const char *scratch_string(size_t handle);
+
+/* count of entries of the histogram of the probes */
+#define SCRATCH_HISTOGRAM  8
+
+/* statistics of the scratch area and of the recorded strings */
+struct scratch_stats {
+    size_t entries;       /* count of recorded strings */
+    size_t bytes;         /* count of bytes allocated for recording */
+    size_t probes;        /* total count of slots probed to find the strings */
+    size_t capacity;      /* capacity of the scratch area of the thread */
+    size_t histogram[SCRATCH_HISTOGRAM]; /* strings by count of probes */
+    unsigned long hits;   /* count of strings found recorded */
+    unsigned long misses; /* count of strings recorded */
+};
+
+/*
+ Get in 'stats' the statistics of the scratch area of the calling thread
+ and of the set of the strings returned by scratchcat.
+ The item i of the histogram counts the strings found after probing i+1
+ slots, the last item counting the strings needing more probes.
+*/
+void scratch_stats(struct scratch_stats *stats);
+
+/*
+ Release the scratch area of the calling thread and, if 'strings' isn't
+ zero, the strings returned by scratchcat and scratchcatv and their handles.
+ Releasing the strings is only possible if no other thread calls the
+ functions of scratch.c at the same time.
+*/
+void scratch_trim(int strings);
+
+/*
+ Return the current generation of the strings returned by scratchcat,
+ that changes each time they are released by scratch_trim.
+*/
+size_t scratch_generation();
+
 
 #endif
 
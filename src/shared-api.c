@@ -32,6 +32,7 @@
 #include <unistd.h>
 #include <assert.h>
 #include <syslog.h>
+#include <sched.h>
 
 #ifndef NOT_MULTI_THREAD_SAFE
 #include <pthread.h>
@@ -40,10 +41,15 @@
 #include "tzplatform_variables.h"
 #include "tzplatform_config.h"
 #include "heap.h"
+#include "buffer.h"
 #include "scratch.h"
+#include "arena.h"
 #include "passwd.h"
 #include "foreign.h"
+#include "atomic.h"
 #include "context.h"
+#include "cache.h"
+#include "users.h"
 #include "hashing.h"
 #include "init.h"
 #include "shared-api.h"
@@ -61,6 +67,10 @@ static struct tzplatform_context global_context = {
 /* the signup of names */
 #include "signup.inc"
 
+#if TZPLATFORM_STATS_PROBES != SCRATCH_HISTOGRAM
+#error "TZPLATFORM_STATS_PROBES and SCRATCH_HISTOGRAM differ"
+#endif
+
 /* validate the signup */
 static void validate_signup(char signup[33])
 {
@@ -94,17 +104,114 @@ inline static void unlock(struct tzplatform_context *context)
 #endif
 }
 
-static inline const char *get_lock(int id, struct tzplatform_context *context)
+/* unpublish and release the snapshot of the locked context */
+static void withdraw(struct tzplatform_context *context)
 {
-    lock( context);
+    struct tzplatform_snapshot *snapshot = context->snapshot;
+
+    _ATOMIC_SET_( &context->snapshot, NULL);
+    context->state = RESET;
+    if (snapshot != NULL) {
+        /* wait the end of the current readers */
+        while (_ATOMIC_GET_( &context->readers))
+            sched_yield();
+        snapshot_unref( snapshot);
+    }
+}
+
+/* enter the reading of the values of the context, returns its snapshot */
+static struct tzplatform_snapshot *enter(struct tzplatform_context *context)
+{
+    struct tzplatform_snapshot *snapshot;
+    enum STATE state;
+
+    for (;;) {
+        /* lock free path */
+        _ATOMIC_INC_( &context->readers);
+        snapshot = _ATOMIC_GET_( &context->snapshot);
+        if (snapshot != NULL)
+            return snapshot;
+        _ATOMIC_DEC_( &context->readers);
+
+        /* initialization path */
+        lock( context);
+        if (context->state == RESET)
+            initialize( context);
+        state = context->state;
+        unlock( context);
+
+        if (state == ERROR) {
+            _ATOMIC_INC_( &context->readers);
+            return NULL;
+        }
+    }
+}
 
-    if (id < 0 || (int)_TZPLATFORM_VARIABLES_COUNT_ <= id)
+/* leave the reading of the values of the context */
+static inline void leave(struct tzplatform_context *context)
+{
+    _ATOMIC_DEC_( &context->readers);
+}
+
+/* get the value of 'id', must be followed by a call to 'leave' */
+static inline const char *get_enter(int id, struct tzplatform_context *context)
+{
+    struct tzplatform_snapshot *snapshot = enter( context);
+
+    if (snapshot == NULL || id < 0 || (int)_TZPLATFORM_VARIABLES_COUNT_ <= id)
         return NULL;
 
-    if (context->state == RESET)
-        initialize( context);
+    return snapshot->values[id];
+}
+
+/* record in the users table the unique copies of the values of the
+   'snapshot' computed for the user 'uid', return 0 or -1 on error */
+static int foruid_put(uid_t uid, struct tzplatform_snapshot *snapshot)
+{
+    const char *values[_TZPLATFORM_VARIABLES_COUNT_];
+    const char *array[2];
+    int id;
 
-    return context->state == ERROR ? NULL : context->values[id];
+    array[1] = NULL;
+    for (id = 0 ; id < (int)_TZPLATFORM_VARIABLES_COUNT_ ; id++) {
+        array[0] = snapshot->values[id];
+        values[id] = array[0] == NULL ? NULL : scratchcat( 0, array);
+        if (array[0] != NULL && values[id] == NULL)
+            return -1;
+    }
+    return users_put( uid, snapshot->ids.users, values);
+}
+
+/* get the values of the user 'uid' as recorded in the users table after
+   computing them if needed, must be followed by a call to 'users_leave' */
+static const char * const *foruid_enter(uid_t uid)
+{
+    struct tzplatform_context *context;
+    struct tzplatform_snapshot *snapshot;
+    const char * const *result;
+    unsigned long generation;
+
+    generation = pw_generation();
+    result = users_enter( uid, generation);
+    if (result != NULL)
+        return result;
+    users_leave();
+
+    /* the values are computed in a private context and their unique
+       copies are recorded: neither the global context nor the contexts
+       of the caller are changed and the cache isn't filled */
+    if (tzplatform_context_create( &context) == 0) {
+        context->uncached = 1;
+        if (tzplatform_context_set_user( context, uid) == 0) {
+            snapshot = enter( context);
+            if (snapshot != NULL)
+                foruid_put( uid, snapshot);
+            leave( context);
+        }
+        tzplatform_context_destroy( context);
+    }
+
+    return users_enter( uid, generation);
 }
 
 /*************** PUBLIC API begins here **************/
@@ -120,6 +227,9 @@ int tzplatform_context_create(struct tzplatform_context **result)
 
     context->state = RESET;
     context->user = _USER_NOT_SET_;
+    context->uncached = 0;
+    context->readers = 0;
+    context->snapshot = NULL;
 #ifndef NOT_MULTI_THREAD_SAFE
     pthread_mutex_init( &context->mutex, NULL);
 #endif
@@ -128,8 +238,8 @@ int tzplatform_context_create(struct tzplatform_context **result)
 
 void tzplatform_context_destroy(struct tzplatform_context *context)
 {
-    if (context->state == VALID)
-            heap_destroy( &context->heap);
+    if (context->snapshot != NULL)
+            snapshot_unref( context->snapshot);
     context->state = ERROR;
     free( context);
 }
@@ -142,11 +252,11 @@ void tzplatform_reset()
 void tzplatform_context_reset(struct tzplatform_context *context)
 {
     lock( context);
-    if (context->state != RESET) {
-        if (context->state == VALID)
-            heap_destroy( &context->heap);
-        context->state = RESET;
-    }
+    if (context->state != RESET)
+        withdraw( context);
+    cache_clear();
+    users_clear();
+    reset_base();
     unlock( context);
 }
 
@@ -183,17 +293,24 @@ int tzplatform_set_user(uid_t uid)
 
 int tzplatform_context_set_user(struct tzplatform_context *context, uid_t uid)
 {
+    struct tzplatform_snapshot *snapshot;
+    struct ids ids;
+
     lock( context);
     if (context->user != uid) {
+        /* the user must exist, even if its values are cached */
         if (uid != _USER_NOT_SET_ && !pw_has_uid( uid)) {
             unlock( context);
             return -1;
-	}
-        else {
-            if (context->state == VALID)
-                heap_destroy( &context->heap);
-            context->state = RESET;
-            context->user = uid;
+        }
+        /* the values of the user may be cached */
+        context->user = uid;
+        get_ids( context, &ids);
+        snapshot = cache_probe( &ids);
+        withdraw( context);
+        if (snapshot != NULL) {
+            _ATOMIC_SET_( &context->snapshot, snapshot);
+            context->state = VALID;
         }
     }
     unlock( context);
@@ -201,6 +318,89 @@ int tzplatform_context_set_user(struct tzplatform_context *context, uid_t uid)
     return 0;
 }
 
+int tzplatform_prefetch_users(const uid_t *uids, size_t count)
+{
+    struct tzplatform_snapshot **snapshots;
+    size_t index;
+    int result;
+
+    if (count == 0)
+        return 0;
+    snapshots = malloc( count * sizeof * snapshots);
+    if (snapshots == NULL)
+        return -1;
+
+    /* the users are searched at once in the passwd file and their
+       values are recorded in the users table */
+    result = prefetch( uids, count, snapshots);
+    for (index = 0 ; index < count ; index++) {
+        if (snapshots[index] != NULL) {
+            if (foruid_put( uids[index], snapshots[index]) != 0)
+                result = -1;
+            snapshot_unref( snapshots[index]);
+        }
+    }
+
+    free( snapshots);
+    return result;
+}
+
+struct tzplatform_snapshot *tzplatform_snapshot_acquire()
+{
+    return tzplatform_context_snapshot_acquire( &global_context);
+}
+
+struct tzplatform_snapshot *tzplatform_context_snapshot_acquire(struct tzplatform_context *context)
+{
+    struct tzplatform_snapshot *snapshot;
+
+    snapshot = enter( context);
+    if (snapshot != NULL)
+        snapshot_ref( snapshot);
+    leave( context);
+
+    return snapshot;
+}
+
+void tzplatform_snapshot_release(struct tzplatform_snapshot *snapshot)
+{
+    snapshot_unref( snapshot);
+}
+
+tzplatform_path_handle tzplatform_path_to_handle(const char *path)
+{
+    return (tzplatform_path_handle)scratch_handle( path);
+}
+
+const char *tzplatform_handle_to_path(tzplatform_path_handle handle)
+{
+    return scratch_string( (size_t)handle);
+}
+
+void tzplatform_stats(struct tzplatform_stats *stats)
+{
+    struct scratch_stats sstats;
+    int i;
+
+    scratch_stats( &sstats);
+    stats->entries = sstats.entries;
+    stats->bytes = sstats.bytes;
+    stats->average_probes = sstats.entries ? (double)sstats.probes / (double)sstats.entries : 0;
+    stats->scratch = sstats.capacity;
+    for (i = 0 ; i < TZPLATFORM_STATS_PROBES ; i++)
+        stats->probes[i] = sstats.histogram[i];
+    stats->hits = sstats.hits;
+    stats->misses = sstats.misses;
+}
+
+void tzplatform_trim(int strings)
+{
+    /* the users table records strings of the scratch */
+    if (strings)
+        users_clear();
+    scratch_trim( strings);
+}
+
 /*************** PUBLIC INTERNAL API begins here **************/
 
 const char* _getname_tzplatform_(int id, char signup[33])
@@ -222,17 +422,61 @@ const char* _getenv_tzplatform_(int id, char signup[33])
 
 const char* _context_getenv_tzplatform_(int id, char signup[33], struct tzplatform_context *context)
 {
+    struct tzplatform_snapshot *snapshot;
     const char *array[2];
     const char *result;
+    int memo;
 
     check_signup(signup);
-    result = get_lock(id, context);
-    if (result != NULL) {
-        array[0] = result;
-        array[1] = NULL;
-        result = scratchcat( 0, array);
+    snapshot = enter( context);
+    if (snapshot == NULL || id < 0 || (int)_TZPLATFORM_VARIABLES_COUNT_ <= id)
+        result = NULL;
+    else {
+        /* the unique copy is made only once per snapshot */
+        memo = snapshot->generation == scratch_generation();
+        result = memo ? _ATOMIC_GET_( &snapshot->unique[id]) : NULL;
+        if (result == NULL && snapshot->values[id] != NULL) {
+            array[0] = snapshot->values[id];
+            array[1] = NULL;
+            result = scratchcat( 0, array);
+            if (memo && result != NULL)
+                _ATOMIC_SET_( &snapshot->unique[id], result);
+        }
     }
-    unlock( context);
+    leave( context);
+    return result;
+}
+
+const char* _snapshot_getenv_tzplatform_(int id, char signup[33], struct tzplatform_snapshot *snapshot)
+{
+    check_signup(signup);
+    return 0 <= id && id < _TZPLATFORM_VARIABLES_COUNT_ ? snapshot->values[id] : NULL;
+}
+
+int _getenv_many_tzplatform_(const enum tzplatform_variable *ids, size_t count, const char **values, char signup[33])
+{
+    return _context_getenv_many_tzplatform_(ids, count, values, signup, &global_context);
+}
+
+int _context_getenv_many_tzplatform_(const enum tzplatform_variable *ids, size_t count, const char **values, char signup[33], struct tzplatform_context *context)
+{
+    struct tzplatform_snapshot *snapshot;
+    size_t i;
+    int id, result;
+
+    check_signup(signup);
+    result = 0;
+    snapshot = enter( context);
+    for (i = 0 ; i < count ; i++) {
+        id = (int)ids[i];
+        if (snapshot == NULL || id < 0 || (int)_TZPLATFORM_VARIABLES_COUNT_ <= id)
+            values[i] = NULL;
+        else
+            values[i] = snapshot->values[id];
+        if (values[i] == NULL)
+            result = -1;
+    }
+    leave( context);
     return result;
 }
 
@@ -243,13 +487,60 @@ int _getenv_int_tzplatform_(int id, char signup[33])
 
 int _context_getenv_int_tzplatform_(int id, char signup[33], struct tzplatform_context *context)
 {
+    struct tzplatform_snapshot *snapshot;
     const char *value;
     int result;
 
     check_signup(signup);
-    value = get_lock(id, context);
-    result = value==NULL ? -1 : atoi(value);
-    unlock( context);
+    snapshot = enter( context);
+    if (snapshot == NULL || id < 0 || (int)_TZPLATFORM_VARIABLES_COUNT_ <= id)
+        result = -1;
+    else if (_ATOMIC_GET_( &snapshot->hasint[id]))
+        result = _ATOMIC_GET_( &snapshot->ints[id]);
+    else {
+        value = snapshot->values[id];
+        result = value==NULL ? -1 : atoi(value);
+        _ATOMIC_SET_( &snapshot->ints[id], result);
+        _ATOMIC_SET_( &snapshot->hasint[id], 1);
+    }
+    leave( context);
+    return result;
+}
+
+const char* _getenv_for_uid_tzplatform_(int id, char signup[33], uid_t uid)
+{
+    const char * const *values;
+    const char *result;
+
+    check_signup(signup);
+    if (uid == _USER_NOT_SET_ || id < 0 || (int)_TZPLATFORM_VARIABLES_COUNT_ <= id)
+        return NULL;
+
+    values = foruid_enter( uid);
+    result = values == NULL ? NULL : values[id];
+    users_leave();
+    return result;
+}
+
+const char* _mkpath_for_uid_tzplatform_(int id, const char * path, char signup[33], uid_t uid)
+{
+    const char * const *values;
+    const char *array[3];
+    const char *result;
+
+    check_signup(signup);
+    if (uid == _USER_NOT_SET_ || id < 0 || (int)_TZPLATFORM_VARIABLES_COUNT_ <= id)
+        return NULL;
+
+    values = foruid_enter( uid);
+    result = values == NULL ? NULL : values[id];
+    if (result != NULL) {
+        array[0] = result;
+        array[1] = path;
+        array[2] = NULL;
+        result = scratchcat( 1, array);
+    }
+    users_leave();
     return result;
 }
 
@@ -264,14 +555,14 @@ const char* _context_mkstr_tzplatform_(int id, const char *str, char signup[33],
     const char *result;
 
     check_signup(signup);
-    result = get_lock(id, context);
+    result = get_enter(id, context);
     if (result != NULL) {
         array[0] = result;
         array[1] = str;
         array[2] = NULL;
         result = scratchcat( 0, array);
     }
-    unlock( context);
+    leave( context);
     return result;
 }
 
@@ -286,14 +577,14 @@ const char* _context_mkpath_tzplatform_(int id, const char *path, char signup[33
     const char *result;
 
     check_signup(signup);
-    result = get_lock(id, context);
+    result = get_enter(id, context);
     if (result != NULL) {
         array[0] = result;
         array[1] = path;
         array[2] = NULL;
         result = scratchcat( 1, array);
     }
-    unlock( context);
+    leave( context);
     return result;
 }
 
@@ -308,7 +599,7 @@ const char* _context_mkpath3_tzplatform_(int id, const char *path, const char *p
     const char *result;
 
     check_signup(signup);
-    result = get_lock(id, context);
+    result = get_enter(id, context);
     if (result != NULL) {
         array[0] = result;
         array[1] = path;
@@ -316,7 +607,7 @@ const char* _context_mkpath3_tzplatform_(int id, const char *path, const char *p
         array[3] = NULL;
         result = scratchcat( 1, array);
     }
-    unlock( context);
+    leave( context);
     return result;
 }
 
@@ -331,7 +622,7 @@ const char* _context_mkpath4_tzplatform_(int id, const char *path, const char *p
     const char *result;
 
     check_signup(signup);
-    result = get_lock(id, context);
+    result = get_enter(id, context);
     if (result != NULL) {
         array[0] = result;
         array[1] = path;
@@ -340,7 +631,7 @@ const char* _context_mkpath4_tzplatform_(int id, const char *path, const char *p
         array[4] = NULL;
         result = scratchcat( 1, array);
     }
-    unlock( context);
+    leave( context);
     return result;
 }
 
@@ -351,16 +642,26 @@ uid_t _getuid_tzplatform_(int id, char signup[33])
 
 uid_t _context_getuid_tzplatform_(int id, char signup[33], struct tzplatform_context *context)
 {
+    struct tzplatform_snapshot *snapshot;
     uid_t result;
     const char *value;
 
     check_signup(signup);
     result = (uid_t)-1;
-    value = get_lock(id, context);
-    if (value != NULL) {
-        pw_get_uid( value, &result);
+    snapshot = enter( context);
+    if (snapshot != NULL && 0 <= id && id < (int)_TZPLATFORM_VARIABLES_COUNT_) {
+        if (_ATOMIC_GET_( &snapshot->hasuid[id]))
+            result = _ATOMIC_GET_( &snapshot->uids[id]);
+        else {
+            /* only the found values are recorded */
+            value = snapshot->values[id];
+            if (value != NULL && pw_get_uid( value, &result) == 0) {
+                _ATOMIC_SET_( &snapshot->uids[id], result);
+                _ATOMIC_SET_( &snapshot->hasuid[id], 1);
+            }
+        }
     }
-    unlock( context);
+    leave( context);
     return result;
 }
 
@@ -371,16 +672,197 @@ gid_t _getgid_tzplatform_(int id, char signup[33])
 
 gid_t _context_getgid_tzplatform_(int id, char signup[33], struct tzplatform_context *context)
 {
+    struct tzplatform_snapshot *snapshot;
     gid_t result;
     const char *value;
 
     check_signup(signup);
-    result = (uid_t)-1;
-    value = get_lock(id, context);
-    if (value != NULL) {
-        pw_get_gid( value, &result);
+    result = (gid_t)-1;
+    snapshot = enter( context);
+    if (snapshot != NULL && 0 <= id && id < (int)_TZPLATFORM_VARIABLES_COUNT_) {
+        if (_ATOMIC_GET_( &snapshot->hasgid[id]))
+            result = _ATOMIC_GET_( &snapshot->gids[id]);
+        else {
+            /* only the found values are recorded */
+            value = snapshot->values[id];
+            if (value != NULL && pw_get_gid( value, &result) == 0) {
+                _ATOMIC_SET_( &snapshot->gids[id], result);
+                _ATOMIC_SET_( &snapshot->hasgid[id], 1);
+            }
+        }
     }
-    unlock( context);
+    leave( context);
     return result;
 }
 
+const char* _mkpathv_tzplatform_(int id, const char *const *components, size_t count, char signup[33])
+{
+    return _context_mkpathv_tzplatform_(id, components, count, signup, &global_context);
+}
+
+const char* _context_mkpathv_tzplatform_(int id, const char *const *components, size_t count, char signup[33], struct tzplatform_context *context)
+{
+    const char *result;
+
+    check_signup(signup);
+    result = get_enter(id, context);
+    if (result != NULL)
+        result = scratchcatv( 1, result, components, count);
+    leave( context);
+    return result;
+}
+
+static int copy_enter(int id, int ispath, const char **array, char *buffer, size_t size, struct tzplatform_context *context)
+{
+    const char *value;
+    int result;
+
+    value = get_enter(id, context);
+    if (value == NULL)
+        result = -1;
+    else {
+        array[0] = value;
+        result = (int)scratchcpy( ispath, array, buffer, size);
+    }
+    leave( context);
+    return result;
+}
+
+int _mkstr_r_tzplatform_(int id, const char *str, char *buffer, size_t size, char signup[33])
+{
+    return _context_mkstr_r_tzplatform_(id, str, buffer, size, signup, &global_context);
+}
+
+int _context_mkstr_r_tzplatform_(int id, const char *str, char *buffer, size_t size, char signup[33], struct tzplatform_context *context)
+{
+    const char *array[3];
+
+    check_signup(signup);
+    array[1] = str;
+    array[2] = NULL;
+    return copy_enter(id, 0, array, buffer, size, context);
+}
+
+int _mkpath_r_tzplatform_(int id, const char *path, char *buffer, size_t size, char signup[33])
+{
+    return _context_mkpath_r_tzplatform_(id, path, buffer, size, signup, &global_context);
+}
+
+int _context_mkpath_r_tzplatform_(int id, const char *path, char *buffer, size_t size, char signup[33], struct tzplatform_context *context)
+{
+    const char *array[3];
+
+    check_signup(signup);
+    array[1] = path;
+    array[2] = NULL;
+    return copy_enter(id, 1, array, buffer, size, context);
+}
+
+int _mkpath3_r_tzplatform_(int id, const char *path, const char *path2, char *buffer, size_t size, char signup[33])
+{
+    return _context_mkpath3_r_tzplatform_(id, path, path2, buffer, size, signup, &global_context);
+}
+
+int _context_mkpath3_r_tzplatform_(int id, const char *path, const char *path2, char *buffer, size_t size, char signup[33], struct tzplatform_context *context)
+{
+    const char *array[4];
+
+    check_signup(signup);
+    array[1] = path;
+    array[2] = path2;
+    array[3] = NULL;
+    return copy_enter(id, 1, array, buffer, size, context);
+}
+
+int _mkpath4_r_tzplatform_(int id, const char *path, const char *path2, const char *path3, char *buffer, size_t size, char signup[33])
+{
+    return _context_mkpath4_r_tzplatform_(id, path, path2, path3, buffer, size, signup, &global_context);
+}
+
+int _context_mkpath4_r_tzplatform_(int id, const char *path, const char *path2, const char *path3, char *buffer, size_t size, char signup[33], struct tzplatform_context *context)
+{
+    const char *array[5];
+
+    check_signup(signup);
+    array[1] = path;
+    array[2] = path2;
+    array[3] = path3;
+    array[4] = NULL;
+    return copy_enter(id, 1, array, buffer, size, context);
+}
+
+static const char *arena_enter(int id, int ispath, const char **array, struct tzplatform_arena *arena, struct tzplatform_context *context)
+{
+    const char *result;
+
+    result = get_enter(id, context);
+    if (result != NULL) {
+        array[0] = result;
+        result = arenacat( arena, ispath, array);
+    }
+    leave( context);
+    return result;
+}
+
+const char* _arena_mkstr_tzplatform_(int id, const char *str, char signup[33], struct tzplatform_arena *arena)
+{
+    return _context_arena_mkstr_tzplatform_(id, str, signup, &global_context, arena);
+}
+
+const char* _context_arena_mkstr_tzplatform_(int id, const char *str, char signup[33], struct tzplatform_context *context, struct tzplatform_arena *arena)
+{
+    const char *array[3];
+
+    check_signup(signup);
+    array[1] = str;
+    array[2] = NULL;
+    return arena_enter(id, 0, array, arena, context);
+}
+
+const char* _arena_mkpath_tzplatform_(int id, const char *path, char signup[33], struct tzplatform_arena *arena)
+{
+    return _context_arena_mkpath_tzplatform_(id, path, signup, &global_context, arena);
+}
+
+const char* _context_arena_mkpath_tzplatform_(int id, const char *path, char signup[33], struct tzplatform_context *context, struct tzplatform_arena *arena)
+{
+    const char *array[3];
+
+    check_signup(signup);
+    array[1] = path;
+    array[2] = NULL;
+    return arena_enter(id, 1, array, arena, context);
+}
+
+const char* _arena_mkpath3_tzplatform_(int id, const char *path, const char *path2, char signup[33], struct tzplatform_arena *arena)
+{
+    return _context_arena_mkpath3_tzplatform_(id, path, path2, signup, &global_context, arena);
+}
+
+const char* _context_arena_mkpath3_tzplatform_(int id, const char *path, const char *path2, char signup[33], struct tzplatform_context *context, struct tzplatform_arena *arena)
+{
+    const char *array[4];
+
+    check_signup(signup);
+    array[1] = path;
+    array[2] = path2;
+    array[3] = NULL;
+    return arena_enter(id, 1, array, arena, context);
+}
+
+const char* _arena_mkpath4_tzplatform_(int id, const char *path, const char *path2, const char *path3, char signup[33], struct tzplatform_arena *arena)
+{
+    return _context_arena_mkpath4_tzplatform_(id, path, path2, path3, signup, &global_context, arena);
+}
+
+const char* _context_arena_mkpath4_tzplatform_(int id, const char *path, const char *path2, const char *path3, char signup[33], struct tzplatform_context *context, struct tzplatform_arena *arena)
+{
+    const char *array[5];
+
+    check_signup(signup);
+    array[1] = path;
+    array[2] = path2;
+    array[3] = path3;
+    array[4] = NULL;
+    return arena_enter(id, 1, array, arena, context);
+}
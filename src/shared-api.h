@@ -29,6 +29,11 @@ extern const char* _getname_tzplatform_(int id, char signup[33]);
 extern int _getid_tzplatform_(const char *name, char signup[33]);
 extern const char* _getenv_tzplatform_(int id, char signup[33]) ;
 extern const char* _context_getenv_tzplatform_(int id, char signup[33], struct tzplatform_context *context);
+extern const char* _snapshot_getenv_tzplatform_(int id, char signup[33], struct tzplatform_snapshot *snapshot);
+extern const char* _getenv_for_uid_tzplatform_(int id, char signup[33], uid_t uid);
+extern const char* _mkpath_for_uid_tzplatform_(int id, const char *path, char signup[33], uid_t uid);
+extern int _getenv_many_tzplatform_(const enum tzplatform_variable *ids, size_t count, const char **values, char signup[33]);
+extern int _context_getenv_many_tzplatform_(const enum tzplatform_variable *ids, size_t count, const char **values, char signup[33], struct tzplatform_context *context);
 extern int _getenv_int_tzplatform_(int id, char signup[33]);
 extern int _context_getenv_int_tzplatform_(int id, char signup[33], struct tzplatform_context *context);
 extern const char* _mkstr_tzplatform_(int id, const char * str, char signup[33]);
@@ -39,6 +44,24 @@ extern const char* _mkpath3_tzplatform_(int id, const char * path, const char* p
 extern const char* _context_mkpath3_tzplatform_(int id, const char *path, const char *path2, char signup[33], struct tzplatform_context *context);
 extern const char* _mkpath4_tzplatform_(int id, const char * path, const char* path2, const char *path3, char signup[33]);
 extern const char* _context_mkpath4_tzplatform_(int id, const char *path, const char *path2, const char *path3, char signup[33], struct tzplatform_context *context);
+extern const char* _mkpathv_tzplatform_(int id, const char *const *components, size_t count, char signup[33]);
+extern const char* _context_mkpathv_tzplatform_(int id, const char *const *components, size_t count, char signup[33], struct tzplatform_context *context);
+extern int _mkstr_r_tzplatform_(int id, const char *str, char *buffer, size_t size, char signup[33]);
+extern int _context_mkstr_r_tzplatform_(int id, const char *str, char *buffer, size_t size, char signup[33], struct tzplatform_context *context);
+extern int _mkpath_r_tzplatform_(int id, const char *path, char *buffer, size_t size, char signup[33]);
+extern int _context_mkpath_r_tzplatform_(int id, const char *path, char *buffer, size_t size, char signup[33], struct tzplatform_context *context);
+extern int _mkpath3_r_tzplatform_(int id, const char *path, const char *path2, char *buffer, size_t size, char signup[33]);
+extern int _context_mkpath3_r_tzplatform_(int id, const char *path, const char *path2, char *buffer, size_t size, char signup[33], struct tzplatform_context *context);
+extern int _mkpath4_r_tzplatform_(int id, const char *path, const char *path2, const char *path3, char *buffer, size_t size, char signup[33]);
+extern int _context_mkpath4_r_tzplatform_(int id, const char *path, const char *path2, const char *path3, char *buffer, size_t size, char signup[33], struct tzplatform_context *context);
+extern const char* _arena_mkstr_tzplatform_(int id, const char *str, char signup[33], struct tzplatform_arena *arena);
+extern const char* _context_arena_mkstr_tzplatform_(int id, const char *str, char signup[33], struct tzplatform_context *context, struct tzplatform_arena *arena);
+extern const char* _arena_mkpath_tzplatform_(int id, const char *path, char signup[33], struct tzplatform_arena *arena);
+extern const char* _context_arena_mkpath_tzplatform_(int id, const char *path, char signup[33], struct tzplatform_context *context, struct tzplatform_arena *arena);
+extern const char* _arena_mkpath3_tzplatform_(int id, const char *path, const char *path2, char signup[33], struct tzplatform_arena *arena);
+extern const char* _context_arena_mkpath3_tzplatform_(int id, const char *path, const char *path2, char signup[33], struct tzplatform_context *context, struct tzplatform_arena *arena);
+extern const char* _arena_mkpath4_tzplatform_(int id, const char *path, const char *path2, const char *path3, char signup[33], struct tzplatform_arena *arena);
+extern const char* _context_arena_mkpath4_tzplatform_(int id, const char *path, const char *path2, const char *path3, char signup[33], struct tzplatform_context *context, struct tzplatform_arena *arena);
 extern uid_t _getuid_tzplatform_(int id, char signup[33]);
 extern uid_t _context_getuid_tzplatform_(int id, char signup[33], struct tzplatform_context *context);
 extern gid_t _getgid_tzplatform_(int id, char signup[33]);
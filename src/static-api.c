@@ -61,6 +61,31 @@ const char* tzplatform_context_getenv(struct tzplatform_context *context, enum t
     return _context_getenv_tzplatform_(id, tizen_platform_config_signup, context);
 }
 
+const char* tzplatform_snapshot_getenv(struct tzplatform_snapshot *snapshot, enum tzplatform_variable id)
+{
+    return _snapshot_getenv_tzplatform_(id, tizen_platform_config_signup, snapshot);
+}
+
+const char* tzplatform_getenv_for_uid(uid_t uid, enum tzplatform_variable id)
+{
+    return _getenv_for_uid_tzplatform_(id, tizen_platform_config_signup, uid);
+}
+
+const char* tzplatform_mkpath_for_uid(uid_t uid, enum tzplatform_variable id, const char *path)
+{
+    return _mkpath_for_uid_tzplatform_(id, path, tizen_platform_config_signup, uid);
+}
+
+int tzplatform_getenv_many(const enum tzplatform_variable *ids, size_t count, const char **values)
+{
+    return _getenv_many_tzplatform_(ids, count, values, tizen_platform_config_signup);
+}
+
+int tzplatform_context_getenv_many(struct tzplatform_context *context, const enum tzplatform_variable *ids, size_t count, const char **values)
+{
+    return _context_getenv_many_tzplatform_(ids, count, values, tizen_platform_config_signup, context);
+}
+
 int tzplatform_getenv_int(enum tzplatform_variable id)
 {
     return _getenv_int_tzplatform_(id, tizen_platform_config_signup);
@@ -111,6 +136,96 @@ const char* tzplatform_context_mkpath4(struct tzplatform_context *context, enum
     return _context_mkpath4_tzplatform_(id, path, path2, path3, tizen_platform_config_signup, context);
 }
 
+const char* tzplatform_mkpathv(enum tzplatform_variable id, const char *const *components, size_t count)
+{
+    return _mkpathv_tzplatform_(id, components, count, tizen_platform_config_signup);
+}
+
+const char* tzplatform_context_mkpathv(struct tzplatform_context *context, enum tzplatform_variable id, const char *const *components, size_t count)
+{
+    return _context_mkpathv_tzplatform_(id, components, count, tizen_platform_config_signup, context);
+}
+
+int tzplatform_mkstr_r(enum tzplatform_variable id, const char *str, char *buffer, size_t size)
+{
+    return _mkstr_r_tzplatform_(id, str, buffer, size, tizen_platform_config_signup);
+}
+
+int tzplatform_context_mkstr_r(struct tzplatform_context *context, enum tzplatform_variable id, const char *str, char *buffer, size_t size)
+{
+    return _context_mkstr_r_tzplatform_(id, str, buffer, size, tizen_platform_config_signup, context);
+}
+
+int tzplatform_mkpath_r(enum tzplatform_variable id, const char *path, char *buffer, size_t size)
+{
+    return _mkpath_r_tzplatform_(id, path, buffer, size, tizen_platform_config_signup);
+}
+
+int tzplatform_context_mkpath_r(struct tzplatform_context *context, enum tzplatform_variable id, const char *path, char *buffer, size_t size)
+{
+    return _context_mkpath_r_tzplatform_(id, path, buffer, size, tizen_platform_config_signup, context);
+}
+
+int tzplatform_mkpath3_r(enum tzplatform_variable id, const char *path, const char *path2, char *buffer, size_t size)
+{
+    return _mkpath3_r_tzplatform_(id, path, path2, buffer, size, tizen_platform_config_signup);
+}
+
+int tzplatform_context_mkpath3_r(struct tzplatform_context *context, enum tzplatform_variable id, const char *path, const char *path2, char *buffer, size_t size)
+{
+    return _context_mkpath3_r_tzplatform_(id, path, path2, buffer, size, tizen_platform_config_signup, context);
+}
+
+int tzplatform_mkpath4_r(enum tzplatform_variable id, const char *path, const char *path2, const char *path3, char *buffer, size_t size)
+{
+    return _mkpath4_r_tzplatform_(id, path, path2, path3, buffer, size, tizen_platform_config_signup);
+}
+
+int tzplatform_context_mkpath4_r(struct tzplatform_context *context, enum tzplatform_variable id, const char *path, const char *path2, const char *path3, char *buffer, size_t size)
+{
+    return _context_mkpath4_r_tzplatform_(id, path, path2, path3, buffer, size, tizen_platform_config_signup, context);
+}
+
+const char* tzplatform_arena_mkstr(struct tzplatform_arena *arena, enum tzplatform_variable id, const char *str)
+{
+    return _arena_mkstr_tzplatform_(id, str, tizen_platform_config_signup, arena);
+}
+
+const char* tzplatform_context_arena_mkstr(struct tzplatform_context *context, struct tzplatform_arena *arena, enum tzplatform_variable id, const char *str)
+{
+    return _context_arena_mkstr_tzplatform_(id, str, tizen_platform_config_signup, context, arena);
+}
+
+const char* tzplatform_arena_mkpath(struct tzplatform_arena *arena, enum tzplatform_variable id, const char *path)
+{
+    return _arena_mkpath_tzplatform_(id, path, tizen_platform_config_signup, arena);
+}
+
+const char* tzplatform_context_arena_mkpath(struct tzplatform_context *context, struct tzplatform_arena *arena, enum tzplatform_variable id, const char *path)
+{
+    return _context_arena_mkpath_tzplatform_(id, path, tizen_platform_config_signup, context, arena);
+}
+
+const char* tzplatform_arena_mkpath3(struct tzplatform_arena *arena, enum tzplatform_variable id, const char *path, const char *path2)
+{
+    return _arena_mkpath3_tzplatform_(id, path, path2, tizen_platform_config_signup, arena);
+}
+
+const char* tzplatform_context_arena_mkpath3(struct tzplatform_context *context, struct tzplatform_arena *arena, enum tzplatform_variable id, const char *path, const char *path2)
+{
+    return _context_arena_mkpath3_tzplatform_(id, path, path2, tizen_platform_config_signup, context, arena);
+}
+
+const char* tzplatform_arena_mkpath4(struct tzplatform_arena *arena, enum tzplatform_variable id, const char *path, const char *path2, const char *path3)
+{
+    return _arena_mkpath4_tzplatform_(id, path, path2, path3, tizen_platform_config_signup, arena);
+}
+
+const char* tzplatform_context_arena_mkpath4(struct tzplatform_context *context, struct tzplatform_arena *arena, enum tzplatform_variable id, const char *path, const char *path2, const char *path3)
+{
+    return _context_arena_mkpath4_tzplatform_(id, path, path2, path3, tizen_platform_config_signup, context, arena);
+}
+
 uid_t tzplatform_getuid(enum tzplatform_variable id)
 {
     return _getuid_tzplatform_(id, tizen_platform_config_signup);
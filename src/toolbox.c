@@ -29,8 +29,10 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
 #include <string.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <sys/wait.h>
 #include <stdarg.h>
 
@@ -39,6 +41,7 @@
 #include "buffer.h"
 #include "foreign.h"
 #include "sha256sum.h"
+#include "image.h"
 
 /*======================================================================*/
 
@@ -78,7 +81,8 @@ usage: "TOOLNAME" [command] [--] [file]\n\
 \n\
 You can specify the 'file' to process.\n\
 The default file is "CONFIGPATH"\n\
-Specifying - mean the standard input.\n\
+Specifying - mean the standard input, that is read by chunks\n\
+(except for the commands pretty and image that read it whole).\n\
 \n\
 Commands:\n\
 \n\
@@ -89,6 +93,7 @@ h          Produce the C header with the enumeration of the variables\n\
 c          Produce the C code to hash the variable names\n\
 rpm        Produce the macro file to use with RPM\n\
 signup     Produce the signup data for the proxy linked statically\n\
+image      Produce the binary image of the 'file' loaded at runtime\n\
 \n\
 ";
 
@@ -162,7 +167,7 @@ static int errcount = 0;
 static int dependant = 0;
 
 /* action to perform */
-static enum { CHECK, PRETTY, GENC, GENH, RPM, SIGNUP } action = CHECK;
+static enum { CHECK, PRETTY, GENC, GENH, RPM, SIGNUP, IMAGE } action = CHECK;
 
 /* output of error */
 static int notstderr = 0;
@@ -292,7 +297,7 @@ static struct var *var_add( const char *name, size_t lname,
     size_t length;
 
     /* check for the value */
-    if (action == RPM && value != NULL) {
+    if ((action == RPM || action == IMAGE) && value != NULL) {
         length = strlen( value) + 1;
     }
     else {
@@ -319,6 +324,14 @@ static struct var *var_add( const char *name, size_t lname,
         if (value) {
             memcpy( normal, value, length);
         }
+        else if (action == IMAGE) {
+            /* foreign variable: template of the image */
+            *normal++ = IMAGE_FOREIGN_BEGIN;
+            memcpy( normal, name, lname);
+            normal += lname;
+            *normal++ = IMAGE_FOREIGN_END;
+            *normal = 0;
+        }
         else {
             *normal++ = '$';
             *normal++ = '{';
@@ -680,21 +693,13 @@ static int rpm( FILE *output)
     return 0;
 }
 
-/* generate the signup */
-static int signup( FILE *output)
+/* compute the signup of the sorted keys */
+static int compute_signup( char signup[32])
 {
     struct key *key;
     int status;
-    int i;
     struct sha256sum *sum;
     char term;
-    char signup[32];
-
-#ifndef NO_SORT_KEYS
-    status = sortkeys();
-    if (status < 0)
-        return status;
-#endif
 
     sum = sha256sum_create();
     if (sum == NULL)
@@ -711,6 +716,24 @@ static int signup( FILE *output)
     }
 
     status = sha256sum_get(sum, signup);
+    sha256sum_destroy(sum);
+    return status;
+}
+
+/* generate the signup */
+static int signup( FILE *output)
+{
+    int status;
+    int i;
+    char signup[32];
+
+#ifndef NO_SORT_KEYS
+    status = sortkeys();
+    if (status < 0)
+        return status;
+#endif
+
+    status = compute_signup( signup);
     if (status < 0)
         return status;
 
@@ -732,31 +755,118 @@ static int signup( FILE *output)
     return 0;
 }
 
+/* generate the binary image of the 'confsize' bytes of 'conf' */
+static int image( const char *conf, size_t confsize, FILE *output)
+{
+    struct key *key;
+    struct image_header header;
+    struct image_entry entry;
+    size_t length, poolsize;
+    int status, count;
+
+#ifndef NO_SORT_KEYS
+    status = sortkeys();
+    if (status < 0)
+        return status;
+#endif
+
+    /* compute the entries */
+    count = 0;
+    poolsize = 0;
+    for (key = keys ; key != NULL ; key = key->next) {
+        length = strcspn( key->value, "\001\002");
+        if (!key->dependant && key->value[length]) {
+            fatal( "the value of %s has forbidden characters", key->name);
+            return -1;
+        }
+        poolsize += strlen( key->value) + 1;
+        count++;
+    }
+    if (poolsize > UINT32_MAX) {
+        fatal( "the values are too big for an image");
+        return -1;
+    }
+
+    /* write the header */
+    memset( &header, 0, sizeof header);
+    memcpy( header.magic, IMAGE_MAGIC, sizeof header.magic);
+    header.version = IMAGE_VERSION;
+    header.count = (uint32_t)count;
+    header.confsize = (uint64_t)confsize;
+    header.confhash = image_hash( conf, confsize);
+    header.poolsize = (uint32_t)poolsize;
+    status = compute_signup( header.signup);
+    if (status < 0)
+        return status;
+    if (fwrite( &header, sizeof header, 1, output) != 1)
+        return -1;
+
+    /* write the entries */
+    poolsize = 0;
+    for (key = keys ; key != NULL ; key = key->next) {
+        length = strlen( key->value);
+        entry.offset = (uint32_t)poolsize;
+        entry.length = (uint32_t)length;
+        entry.flags = key->dependant ? IMAGE_DEPENDANT : 0;
+        if (fwrite( &entry, sizeof entry, 1, output) != 1)
+            return -1;
+        poolsize += length + 1;
+    }
+
+    /* write the pool */
+    for (key = keys ; key != NULL ; key = key->next) {
+        length = strlen( key->value) + 1;
+        if (fwrite( key->value, 1, length, output) != length)
+            return -1;
+    }
+
+    return fflush( output);
+}
+
 /* main of processing */
 static int process()
 {
     struct parsing parsing;
     struct buffer buffer;
-    int result;
-
-    /* read the file */
-    result = buffer_create( &buffer, metafilepath);
-    if (result != 0) {
-        fatal( "can't read file %s", metafilepath);
-        return -1;
-    }
+    int fd, result;
 
     /* parse the file */
-    parsing.buffer = buffer.buffer;
-    parsing.length = buffer.length;
     parsing.maximum_data_size = 0;
-    parsing.should_escape = action!=RPM;
+    parsing.should_escape = action!=RPM && action!=IMAGE;
     parsing.data = 0;
     parsing.get = getcb;
     parsing.put = putcb;
     parsing.error = errcb;
     dependant = 0;
-    result = parse_utf8_config( &parsing);
+    fd = open( metafilepath, O_RDONLY);
+    if (fd < 0) {
+        fatal( "can't read file %s", metafilepath);
+        return -1;
+    }
+    result = buffer_map( &buffer, fd);
+    if (result != 0 && (action == PRETTY || action == IMAGE)) {
+        /* pretty and image need the whole content that is then read */
+        result = buffer_read( &buffer, fd);
+        if (result != 0) {
+            close( fd);
+            fatal( "can't read file %s", metafilepath);
+            return -1;
+        }
+    }
+    if (result == 0) {
+        parsing.buffer = buffer.buffer;
+        parsing.length = buffer.length;
+        result = parse_utf8_config( &parsing);
+    }
+    else {
+        /* the file can't be mapped (standard input), it is parsed while
+           read */
+        buffer.buffer = NULL;
+        buffer.length = 0;
+        buffer.mapped = 0;
+        result = parse_utf8_config_fd( &parsing, fd);
+    }
+    close( fd);
     if (result != 0) {
         buffer_destroy( &buffer);
         fatal( "while parsing the file %s", metafilepath);
@@ -787,10 +897,14 @@ static int process()
     case SIGNUP:
         signup( stdout);
         break;
+    case IMAGE:
+        if (image( buffer.buffer, buffer.length, stdout) != 0)
+            result = -1;
+        break;
     }
 
     buffer_destroy( &buffer);
-    return 0;
+    return result;
 }
 
 /*======================================================================*/
@@ -833,6 +947,10 @@ static int arguments( char **argv)
             action = SIGNUP;
             argv++;
         }
+        else if (0 == strcmp( *argv, "image")) {
+            action = IMAGE;
+            argv++;
+        }
         else if (0 == strcmp( *argv, "help") || 0 == strcmp( *argv, "--help")) {
             printf("%s", help);
             exit(0);
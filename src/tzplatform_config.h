@@ -54,10 +54,123 @@ const char* tzplatform_getname(enum tzplatform_variable id);
 extern
 enum tzplatform_variable tzplatform_getid(const char *name);
 
+/*
+ Handle of a string returned by the functions tzplatform_mkstr,
+ tzplatform_mkpath, tzplatform_mkpath3, tzplatform_mkpath4 and
+ tzplatform_mkpathv and their context variants.
+
+ The handles are small positive integers given in order of creation of
+ the strings: two strings are equal if and only if their handles are equal.
+ The value 0 is never a valid handle.
+*/
+typedef unsigned int tzplatform_path_handle;
+
+/*
+ Return the handle of 'path' that MUST be NULL or a string returned by
+ the functions tzplatform_mkstr, tzplatform_mkpath, tzplatform_mkpath3,
+ tzplatform_mkpath4 or tzplatform_mkpathv or by their context variants.
+ It MUST not be a string built in a buffer or an arena.
+
+ Return 0 if 'path' is NULL or in case of internal error.
+
+ Example:
+
+    tzplatform_path_to_handle(tzplatform_mkpath(TZ_SYS_HOME, "yes"))
+
+    returns the handle of "/opt/home/yes"
+*/
+extern
+tzplatform_path_handle tzplatform_path_to_handle(const char *path);
+
+/*
+ Return the string of the 'handle' or NULL if 'handle' isn't valid.
+*/
+extern
+const char *tzplatform_handle_to_path(tzplatform_path_handle handle);
+
+/*
+ Statistics of the cache of the values computed for users.
+*/
+struct tzplatform_cache_stats {
+    unsigned long hits;     /* count of values found in the cache */
+    unsigned long misses;   /* count of values not found in the cache */
+    unsigned count;         /* count of users recorded in the cache */
+    size_t size;            /* size in bytes of the recorded values */
+};
+
+/*
+ Fill 'stats' with the statistics of the cache of the values computed
+ for users.
+*/
+extern
+void tzplatform_cache_stats(struct tzplatform_cache_stats *stats);
+
+/*
+ Computes the values of the tizen platform variables for each of the
+ 'count' users of the array 'uids' and records them in the table of the
+ users, so that tzplatform_getenv_for_uid and tzplatform_mkpath_for_uid
+ don't have to compute them again. The passwd file is read only once
+ for all the users.
+
+ The table of the users isn't bounded: it keeps all the prefetched users
+ until the passwd file changes or until tzplatform_trim(1) or a reset
+ is called. The cache used by the contexts isn't changed.
+
+ Return 0 in case of success or -1 if one of the users doesn't exist or
+ if its values could not be computed.
+*/
+extern
+int tzplatform_prefetch_users(const uid_t *uids, size_t count);
+
+/* count of entries of the histogram of the probes */
+#define TZPLATFORM_STATS_PROBES  8
+
+/*
+ Statistics of the strings returned by the functions tzplatform_mkstr,
+ tzplatform_mkpath, tzplatform_mkpath3, tzplatform_mkpath4 and
+ tzplatform_mkpathv and their context variants.
+*/
+struct tzplatform_stats {
+    size_t entries;         /* count of distinct strings recorded */
+    size_t bytes;           /* size in bytes allocated for recording */
+    double average_probes;  /* average count of slots probed per string */
+    size_t scratch;         /* capacity of the scratch area of the thread */
+    size_t probes[TZPLATFORM_STATS_PROBES]; /* strings by count of probes */
+    unsigned long hits;     /* count of strings found already recorded */
+    unsigned long misses;   /* count of strings recorded */
+};
+
+/*
+ Fill 'stats' with the statistics of the strings returned by the
+ functions tzplatform_mkstr, tzplatform_mkpath, tzplatform_mkpath3,
+ tzplatform_mkpath4 and tzplatform_mkpathv and their context variants.
+
+ The item i of 'probes' counts the strings found after probing i+1 slots,
+ the last item counting the strings needing more probes.
+ The field 'scratch' is the capacity of the scratch area of the
+ calling thread.
+*/
+extern
+void tzplatform_stats(struct tzplatform_stats *stats);
+
+/*
+ Releases the scratch area of the calling thread.
+
+ If 'strings' isn't zero, the strings returned by the functions
+ tzplatform_mkstr, tzplatform_mkpath, tzplatform_mkpath3, tzplatform_mkpath4
+ and tzplatform_mkpathv and their context variants are also released,
+ with their handles. In that case, the caller asserts that none of these
+ strings or handles is still in use and that no other thread calls
+ these functions during the release.
+*/
+extern
+void tzplatform_trim(int strings);
+
 /*------------------------------ GLOBAL API (default global context) ----*/
 
 /*
  Enforces the removal of the previously evaluated tizen platform variables.
+ The values cached for users are also removed.
 
  Call this function in case of changing of user inside the application.
 */
@@ -96,6 +209,20 @@ void tzplatform_reset_user();
 extern
 const char* tzplatform_getenv(enum tzplatform_variable id);
 
+/*
+ Get in 'values' the read-only string values of the 'count' tizen
+ platform variables of 'ids'. The values are got at once.
+
+ The returned values MUST not be freed. They are valid until the next
+ call to tzplatform_reset or tzplatform_set_user.
+
+ Returns 0 in case of success or -1 if one of the values can't be got,
+ its entry of 'values' being then NULL.
+*/
+extern
+int tzplatform_getenv_many(const enum tzplatform_variable *ids, size_t count,
+                                                        const char **values);
+
 /*
  Return the integer value of the tizen plaform variable 'id'.
 */
@@ -182,10 +309,69 @@ extern
 const char* tzplatform_mkpath4(enum tzplatform_variable id, const char *path,
                                         const char *path2, const char *path3);
 
+/*
+ Return the string resulting of the path-concatenation of string value of the
+ tizen plaform variable 'id' and the 'count' strings of the array 'components'.
+ The NULL items of 'components' are ignored.
+
+ path-concatenation is the concatenation taking care of / characters.
+
+ The returned value is an allocated unique string that MUST not be freed.
+
+ Can return NULL in case of internal error.
+
+ Example:
+    if TZ_SYS_HOME == "/opt/home" then calling
+
+       const char *components[] = { "yes", "no", "/maybe", "/" };
+       tzplatform_mkpathv(TZ_SYS_HOME, components, 4)
+
+    will return "/opt/home/yes/no/maybe/"
+*/
+extern
+const char* tzplatform_mkpathv(enum tzplatform_variable id,
+                        const char *const *components, size_t count);
+
+/*
+ Write in 'buffer' of 'size' bytes the string that tzplatform_mkstr,
+ tzplatform_mkpath, tzplatform_mkpath3 or tzplatform_mkpath4 would
+ return for the same arguments.
+
+ These functions don't record the strings: the result is only in the
+ buffer given by the caller. When 'size' isn't zero, the buffer always
+ receives a terminating null, truncating the string if needed.
+
+ Return the length of the full string (terminating null excluded) or -1
+ in case of error. If the returned value is greater or equal to 'size',
+ the buffer was too small and the string was truncated.
+
+ Example:
+    if TZ_SYS_HOME == "/opt/home" then calling
+
+       tzplatform_mkpath_r(TZ_SYS_HOME, "yes", buffer, sizeof buffer)
+
+    will return 13 and put "/opt/home/yes" in buffer
+*/
+extern
+int tzplatform_mkstr_r(enum tzplatform_variable id, const char *str,
+                                                char *buffer, size_t size);
+extern
+int tzplatform_mkpath_r(enum tzplatform_variable id, const char *path,
+                                                char *buffer, size_t size);
+extern
+int tzplatform_mkpath3_r(enum tzplatform_variable id, const char *path,
+                            const char *path2, char *buffer, size_t size);
+extern
+int tzplatform_mkpath4_r(enum tzplatform_variable id, const char *path,
+        const char *path2, const char *path3, char *buffer, size_t size);
+
 /*
  Return the uid for a given user name, stored in variable <id>
  Retun -1 in case of error.
 
+ The uid found is recorded with the values of the variables: it is
+ looked up again only after a reset or a change of user.
+
  Example:
     if TZ_USER_NAME=="app" then calling:
 
@@ -200,6 +386,9 @@ uid_t tzplatform_getuid(enum tzplatform_variable id);
  Return the gid for a given user name, stored in variable <id>
  Retun -1 in case of error.
 
+ The gid found is recorded with the values of the variables: it is
+ looked up again only after a reset or a change of user.
+
  Example:
     if TZ_USER_NAME=="app" then calling:
 
@@ -230,6 +419,7 @@ void tzplatform_context_destroy(struct tzplatform_context *context);
 
 /*
  Enforces the removal of the previously evaluated tizen platform variables.
+ The values cached for users are also removed.
 */
 extern
 void tzplatform_context_reset(struct tzplatform_context *context);
@@ -267,6 +457,21 @@ void tzplatform_context_reset_user(struct tzplatform_context *context);
 extern
 const char* tzplatform_context_getenv(struct tzplatform_context *context, enum tzplatform_variable id);
 
+/*
+ Get in 'values' the read-only string values of the 'count' tizen
+ platform variables of 'ids'. The values are got at once.
+
+ The returned values MUST not be freed. They are valid until the next
+ call to tzplatform_context_reset or tzplatform_context_set_user.
+
+ Returns 0 in case of success or -1 if one of the values can't be got,
+ its entry of 'values' being then NULL.
+*/
+extern
+int tzplatform_context_getenv_many(struct tzplatform_context *context,
+                                const enum tzplatform_variable *ids,
+                                size_t count, const char **values);
+
 /*
  Return the integer value of the tizen plaform variable 'id'.
 */
@@ -353,10 +558,69 @@ extern
 const char* tzplatform_context_mkpath4(struct tzplatform_context *context, enum tzplatform_variable id, const char *path,
                                         const char *path2, const char *path3);
 
+/*
+ Return the string resulting of the path-concatenation of string value of the
+ tizen plaform variable 'id' and the 'count' strings of the array 'components'.
+ The NULL items of 'components' are ignored.
+
+ path-concatenation is the concatenation taking care of / characters.
+
+ The returned value is an allocated unique string that MUST not be freed.
+
+ Can return NULL in case of internal error.
+
+ Example:
+    if TZ_SYS_HOME == "/opt/home" then calling
+
+       const char *components[] = { "yes", "no", "/maybe", "/" };
+       tzplatform_context_mkpathv(context, TZ_SYS_HOME, components, 4)
+
+    will return "/opt/home/yes/no/maybe/"
+*/
+extern
+const char* tzplatform_context_mkpathv(struct tzplatform_context *context, enum tzplatform_variable id,
+                        const char *const *components, size_t count);
+
+/*
+ Write in 'buffer' of 'size' bytes the string that tzplatform_context_mkstr,
+ tzplatform_context_mkpath, tzplatform_context_mkpath3 or tzplatform_context_mkpath4 would
+ return for the same arguments.
+
+ These functions don't record the strings: the result is only in the
+ buffer given by the caller. When 'size' isn't zero, the buffer always
+ receives a terminating null, truncating the string if needed.
+
+ Return the length of the full string (terminating null excluded) or -1
+ in case of error. If the returned value is greater or equal to 'size',
+ the buffer was too small and the string was truncated.
+
+ Example:
+    if TZ_SYS_HOME == "/opt/home" then calling
+
+       tzplatform_context_mkpath_r(context, TZ_SYS_HOME, "yes", buffer, sizeof buffer)
+
+    will return 13 and put "/opt/home/yes" in buffer
+*/
+extern
+int tzplatform_context_mkstr_r(struct tzplatform_context *context, enum tzplatform_variable id, const char *str,
+                                                char *buffer, size_t size);
+extern
+int tzplatform_context_mkpath_r(struct tzplatform_context *context, enum tzplatform_variable id, const char *path,
+                                                char *buffer, size_t size);
+extern
+int tzplatform_context_mkpath3_r(struct tzplatform_context *context, enum tzplatform_variable id, const char *path,
+                            const char *path2, char *buffer, size_t size);
+extern
+int tzplatform_context_mkpath4_r(struct tzplatform_context *context, enum tzplatform_variable id, const char *path,
+        const char *path2, const char *path3, char *buffer, size_t size);
+
 /*
  Return the uid for a given user name, stored in variable <id>
  Retun -1 in case of error.
 
+ The uid found is recorded with the values of the variables: it is
+ looked up again only after a reset or a change of user.
+
  Example:
     if TZ_USER_NAME=="app" then calling:
 
@@ -371,6 +635,9 @@ uid_t tzplatform_context_getuid(struct tzplatform_context *context, enum tzplatf
  Return the gid for a given user name, stored in variable <id>
  Retun -1 in case of error.
 
+ The gid found is recorded with the values of the variables: it is
+ looked up again only after a reset or a change of user.
+
  Example:
     if TZ_USER_NAME=="app" then calling:
 
@@ -404,6 +671,167 @@ gid_t tzplatform_context_getgid(struct tzplatform_context *context, enum tzplatf
 extern
 int tzplatform_has_system_group(uid_t uid);
 
+/*------------------------------ SNAPSHOT API ----------------------------*/
+
+struct tzplatform_snapshot;
+
+/*
+ Return a snapshot of the values of the tizen platform variables of the
+ global context, or NULL in case of error.
+
+ The snapshot is immutable and remains valid, even if the context is reset
+ or changes of user, until it is released using tzplatform_snapshot_release.
+*/
+extern
+struct tzplatform_snapshot *tzplatform_snapshot_acquire();
+
+/*
+ Return a snapshot of the values of the tizen platform variables of the
+ 'context', or NULL in case of error.
+
+ The snapshot is immutable and remains valid, even if the context is reset
+ or changes of user, until it is released using tzplatform_snapshot_release.
+*/
+extern
+struct tzplatform_snapshot *tzplatform_context_snapshot_acquire(struct tzplatform_context *context);
+
+/*
+ Release the 'snapshot' acquired using tzplatform_snapshot_acquire or
+ tzplatform_context_snapshot_acquire.
+ The released snapshot and its values must not be used after calling
+ this function.
+*/
+extern
+void tzplatform_snapshot_release(struct tzplatform_snapshot *snapshot);
+
+/*
+ Return the read-only string value of the tizen plaform variable 'id'
+ of the 'snapshot'. No lock is involved.
+
+ The returned value MUST not be freed and is valid until the release
+ of the 'snapshot'.
+
+ Can return NULL when 'id' isn't defined.
+*/
+extern
+const char* tzplatform_snapshot_getenv(struct tzplatform_snapshot *snapshot, enum tzplatform_variable id);
+
+/*------------------------------ USERS API -------------------------------*/
+
+/*
+ Return the read-only string value of the tizen plaform variable 'id'
+ computed for the user 'uid', as a context set to that user would do.
+
+ The values of the user are computed once and recorded in a table of
+ the users, so that later calls for the same user are lock free. Neither
+ the global context nor any other context is changed.
+
+ The returned value is an allocated unique string that MUST not be freed.
+
+ Can return NULL in case of internal error, when 'id' isn't defined or
+ when 'uid' isn't a valid user.
+*/
+extern
+const char* tzplatform_getenv_for_uid(uid_t uid, enum tzplatform_variable id);
+
+/*
+ Return the string resulting of the path-concatenation of string value of the
+ tizen plaform variable 'id' computed for the user 'uid' and the given string
+ 'path', as tzplatform_mkpath does for the global context.
+
+ The returned value is an allocated unique string that MUST not be freed.
+
+ Can return NULL in case of internal error, when 'id' isn't defined or
+ when 'uid' isn't a valid user.
+
+ Example:
+    if TZ_USER_HOME == "/home/app" for the user 5000 then calling
+
+       tzplatform_mkpath_for_uid(5000, TZ_USER_HOME, "yes")
+
+    will return "/home/app/yes"
+*/
+extern
+const char* tzplatform_mkpath_for_uid(uid_t uid, enum tzplatform_variable id, const char *path);
+
+/*------------------------------ ARENA API -------------------------------*/
+
+struct tzplatform_arena;
+
+/*
+ Creates a new arena for recording the strings built by the functions
+ tzplatform_arena_mkstr, tzplatform_arena_mkpath, tzplatform_arena_mkpath3
+ and tzplatform_arena_mkpath4 and their context variants.
+ The strings of an arena are all released at once by
+ tzplatform_arena_reset or tzplatform_arena_destroy.
+
+ An arena must not be used by several threads at the same time.
+
+ The pointer for the created arena is stored at 'arena'.
+ Return 0 in case of success or a negative value in case of error.
+*/
+extern
+int tzplatform_arena_create(struct tzplatform_arena **arena);
+
+/*
+ Releases all the strings recorded in the 'arena' that stays usable.
+*/
+extern
+void tzplatform_arena_reset(struct tzplatform_arena *arena);
+
+/*
+ Destroys the 'arena' previously created with 'tzplatform_arena_create'
+ and all its strings.
+ The destroyed arena must not be used after calling this function.
+*/
+extern
+void tzplatform_arena_destroy(struct tzplatform_arena *arena);
+
+/*
+ Return the string that tzplatform_mkstr, tzplatform_mkpath,
+ tzplatform_mkpath3 or tzplatform_mkpath4 would return for the same
+ arguments but recorded in the 'arena'.
+
+ The returned value MUST not be freed and is valid until the reset or the
+ destruction of the 'arena'.
+
+ Can return NULL in case of internal error.
+
+ Example:
+    if TZ_SYS_HOME == "/opt/home" then calling
+
+       tzplatform_arena_mkpath(arena, TZ_SYS_HOME, "yes")
+
+    will return "/opt/home/yes"
+*/
+extern
+const char* tzplatform_arena_mkstr(struct tzplatform_arena *arena, enum tzplatform_variable id, const char *str);
+extern
+const char* tzplatform_arena_mkpath(struct tzplatform_arena *arena, enum tzplatform_variable id, const char *path);
+extern
+const char* tzplatform_arena_mkpath3(struct tzplatform_arena *arena, enum tzplatform_variable id, const char *path, const char *path2);
+extern
+const char* tzplatform_arena_mkpath4(struct tzplatform_arena *arena, enum tzplatform_variable id, const char *path, const char *path2, const char *path3);
+
+/*
+ Return the string that tzplatform_context_mkstr, tzplatform_context_mkpath,
+ tzplatform_context_mkpath3 or tzplatform_context_mkpath4 would return for
+ the same arguments but recorded in the 'arena'.
+
+ The returned value MUST not be freed and is valid until the reset or the
+ destruction of the 'arena'.
+
+ Can return NULL in case of internal error.
+*/
+extern
+const char* tzplatform_context_arena_mkstr(struct tzplatform_context *context, struct tzplatform_arena *arena, enum tzplatform_variable id, const char *str);
+extern
+const char* tzplatform_context_arena_mkpath(struct tzplatform_context *context, struct tzplatform_arena *arena, enum tzplatform_variable id, const char *path);
+extern
+const char* tzplatform_context_arena_mkpath3(struct tzplatform_context *context, struct tzplatform_arena *arena, enum tzplatform_variable id, const char *path, const char *path2);
+extern
+const char* tzplatform_context_arena_mkpath4(struct tzplatform_context *context, struct tzplatform_arena *arena, enum tzplatform_variable id, const char *path, const char *path2, const char *path3);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,246 @@
+/*
+ * Copyright (C) 2013-2014 Intel Corporation.
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Authors:
+ *   José Bollo <jose.bollo@open.eurogiciel.org>
+ *   Stéphane Desneux <stephane.desneux@open.eurogiciel.org>
+ *   Jean-Benoit Martin <jean-benoit.martin@open.eurogiciel.org>
+ *
+ */
+#define _GNU_SOURCE
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sched.h>
+#include <sys/types.h>
+
+#ifndef NOT_MULTI_THREAD_SAFE
+#include <pthread.h>
+#endif
+
+#include "tzplatform_variables.h"
+#include "atomic.h"
+#include "users.h"
+
+#ifndef USERS_INITIAL_CAPACITY
+#define USERS_INITIAL_CAPACITY   16
+#endif
+
+#if USERS_INITIAL_CAPACITY <= 0 || (USERS_INITIAL_CAPACITY & (USERS_INITIAL_CAPACITY - 1))
+#error "bad value for USERS_INITIAL_CAPACITY"
+#endif
+
+/* the values recorded for a user */
+struct user {
+    uid_t uid;
+    const char *values[_TZPLATFORM_VARIABLES_COUNT_];
+};
+
+/*
+ The table of the users, with open addressing. Slots are only added
+ so that readers can search it without locking. When it grows, the
+ previous table is kept until users_clear because readers may still
+ be searching it.
+*/
+struct table {
+    struct table *previous;   /* the previous smaller table */
+    unsigned long generation; /* generation of the users */
+    size_t capacity;          /* count of slots, a power of 2 */
+    size_t count;             /* count of used slots */
+    struct user *slots[];
+};
+
+/* the current table */
+static struct table *table = NULL;
+
+/* count of readers of the current table */
+static int readers = 0;
+
+#ifndef NOT_MULTI_THREAD_SAFE
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/* locks the table for writing */
+inline static void lock()
+{
+#ifndef NOT_MULTI_THREAD_SAFE
+    pthread_mutex_lock( &mutex);
+#endif
+}
+
+/* unlock the table */
+inline static void unlock()
+{
+#ifndef NOT_MULTI_THREAD_SAFE
+    pthread_mutex_unlock( &mutex);
+#endif
+}
+
+/* hash code of 'uid' */
+static inline size_t hashuid( uid_t uid)
+{
+    uint32_t h = (uint32_t)uid;
+
+    h ^= h >> 16;
+    h *= 0x45d9f3bU;
+    h ^= h >> 16;
+    return (size_t)h;
+}
+
+/* search the user 'uid' in 't' */
+static struct user *search( struct table *t, uid_t uid)
+{
+    struct user *user;
+    size_t mask, index;
+
+    mask = t->capacity - 1;
+    index = hashuid( uid) & mask;
+    while ((user = _ATOMIC_GET_( &t->slots[index])) != NULL) {
+        if (user->uid == uid)
+            return user;
+        index = (index + 1) & mask;
+    }
+    return NULL;
+}
+
+/* add the 'user' to 't' that has a free slot */
+static void insert( struct table *t, struct user *user)
+{
+    size_t mask, index;
+
+    mask = t->capacity - 1;
+    index = hashuid( user->uid) & mask;
+    while (t->slots[index] != NULL)
+        index = (index + 1) & mask;
+    _ATOMIC_SET_( &t->slots[index], user);
+    t->count++;
+}
+
+/* creates a table of 'capacity' slots holding the users of 'previous' */
+static struct table *grow( struct table *previous, size_t capacity)
+{
+    struct table *t;
+    size_t index;
+
+    t = calloc( 1, sizeof * t + capacity * sizeof * t->slots);
+    if (t != NULL) {
+        t->previous = previous;
+        t->capacity = capacity;
+        t->count = 0;
+        if (previous != NULL)
+            for (index = 0 ; index < previous->capacity ; index++)
+                if (previous->slots[index] != NULL)
+                    insert( t, previous->slots[index]);
+    }
+    return t;
+}
+
+/* removes all the users, the lock must be held */
+static void discard()
+{
+    struct table *t, *previous;
+    size_t index;
+
+    t = table;
+    _ATOMIC_SET_( &table, NULL);
+    if (t != NULL) {
+        /* wait the end of the current readers */
+        while (_ATOMIC_GET_( &readers))
+            sched_yield();
+
+        /* the current table holds all the users */
+        for (index = 0 ; index < t->capacity ; index++)
+            free( t->slots[index]);
+        while (t != NULL) {
+            previous = t->previous;
+            free( t);
+            t = previous;
+        }
+    }
+}
+
+const char * const *users_enter( uid_t uid, unsigned long generation)
+{
+    struct table *t;
+    struct user *user;
+
+    _ATOMIC_INC_( &readers);
+    t = _ATOMIC_GET_( &table);
+    user = t == NULL || t->generation != generation ? NULL : search( t, uid);
+    return user == NULL ? NULL : user->values;
+}
+
+void users_leave()
+{
+    _ATOMIC_DEC_( &readers);
+}
+
+int users_put( uid_t uid, unsigned long generation,
+                                            const char * const *values)
+{
+    struct table *t;
+    struct user *user;
+
+    lock();
+    t = table;
+    if (t != NULL && t->generation != generation) {
+        if (generation < t->generation) {
+            /* the values are outdated */
+            unlock();
+            return 0;
+        }
+        /* the users changed */
+        discard();
+        t = NULL;
+    }
+    if (t == NULL || search( t, uid) == NULL) {
+
+        /* keep the load factor under 3/4 */
+        if (t == NULL || 4 * (t->count + 1) > 3 * t->capacity) {
+            t = grow( t, t == NULL ? USERS_INITIAL_CAPACITY : 2 * t->capacity);
+            if (t == NULL) {
+                unlock();
+                return -1;
+            }
+            t->generation = generation;
+            _ATOMIC_SET_( &table, t);
+        }
+
+        user = malloc( sizeof * user);
+        if (user == NULL) {
+            unlock();
+            return -1;
+        }
+        user->uid = uid;
+        memcpy( user->values, values, sizeof user->values);
+        insert( t, user);
+    }
+    unlock();
+    return 0;
+}
+
+void users_clear()
+{
+    lock();
+    discard();
+    unlock();
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2013-2014 Intel Corporation.
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Authors:
+ *   José Bollo <jose.bollo@open.eurogiciel.org>
+ *   Stéphane Desneux <stephane.desneux@open.eurogiciel.org>
+ *   Jean-Benoit Martin <jean-benoit.martin@open.eurogiciel.org>
+ *
+ */
+#ifndef TIZEN_PLATFORM_WRAPPER_USERS_H
+#define TIZEN_PLATFORM_WRAPPER_USERS_H
+
+/*
+ The users table records the values computed for users by
+ tzplatform_getenv_for_uid and tzplatform_mkpath_for_uid, indexed
+ by uid. It is read without locking: readers count themselves
+ between users_enter and users_leave and users_clear waits the end
+ of the current readers before releasing the recorded values.
+
+ The values are recorded for a generation of the users (see
+ pw_generation): they are no more found once the users changed and
+ are released when the values of a newer generation are recorded.
+*/
+
+/*
+ Return the array of the values recorded for the user 'uid' in the
+ 'generation' of the users, indexed by the ids of the variables, or
+ NULL if there isn't such user. Must be followed by a call to
+ 'users_leave' that ends the use of the returned array.
+*/
+const char * const *users_enter( uid_t uid, unsigned long generation);
+
+/*
+ End the use of the values returned by 'users_enter'.
+*/
+void users_leave();
+
+/*
+ Record the array of the 'values' of the user 'uid' computed in the
+ 'generation' of the users, indexed by the ids of the variables. The
+ strings of the array are not copied and must remain valid until
+ 'users_clear' is called. Nothing is done if the user is already
+ recorded or if the generation is older than the recorded one.
+
+ Must not be called between users_enter and users_leave.
+
+ Return 0 in case of success or -1 on memory depletion.
+*/
+int users_put( uid_t uid, unsigned long generation,
+                                            const char * const *values);
+
+/*
+ Removes all the users recorded.
+*/
+void users_clear();
+
+#endif
+